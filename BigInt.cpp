@@ -8,11 +8,243 @@ This file contains the implementation of the big_int class. See the header file
 information.
 **************************************************************************/
 
-#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
 #include "BigInt.hpp"
+#include "BigIntKernels.hpp"
 
 namespace vtsu {
 
+    //------------------------------------
+    //          BigInt::LimbBuffer
+    //------------------------------------
+
+    namespace {
+
+        // The memory resource each thread is using (see BigInt::memory_resource).
+        thread_local std::pmr::memory_resource *current_resource = nullptr;
+
+        // Every block of limbs begins with a header that records the resource the block came
+        // from, so that the block can be returned to it. This is an extension of the idea of a
+        // class specific operator new (see check/memclass.h). The allocation function is chosen
+        // when the program runs rather than when it is compiled, and the memory is returned
+        // to the right place even if the allocation function changes in the meantime.
+        //
+        struct BlockHeader {
+            std::pmr::memory_resource *resource;
+        };
+
+        std::size_t block_size( std::size_t limb_count )
+        {
+            return sizeof( BlockHeader ) + limb_count * sizeof( BigInt::limb_type );
+        }
+
+    } // End of anonymous namespace
+
+
+    BigInt::limb_type *BigInt::LimbBuffer::allocate( std::size_t limb_count )
+    {
+        std::pmr::memory_resource *resource = current_resource;
+        std::size_t size = block_size( limb_count );
+        void *block = ( resource == nullptr ) ?
+            ::operator new( size ) : resource->allocate( size, alignof( BlockHeader ) );
+        static_cast<BlockHeader *>( block )->resource = resource;
+        return reinterpret_cast<limb_type *>( static_cast<BlockHeader *>( block ) + 1 );
+    }
+
+
+    void BigInt::LimbBuffer::release( limb_type *pointer, std::size_t limb_count )
+    {
+        BlockHeader *block = reinterpret_cast<BlockHeader *>( pointer ) - 1;
+        if( block->resource == nullptr ) {
+            ::operator delete( block );
+        }
+        else {
+            block->resource->deallocate( block, block_size( limb_count ), alignof( BlockHeader ) );
+        }
+    }
+
+
+    BigInt::LimbBuffer::LimbBuffer( const LimbBuffer &other ) :
+        count( other.count ), capacity( inline_capacity )
+    {
+        // Only allocate if the value doesn't fit in the local buffer. The new buffer is sized
+        // exactly; there is no reason to copy any spare capacity the other buffer might have.
+        //
+        if( count > inline_capacity ) {
+            heap     = allocate( count );
+            capacity = count;
+        }
+        std::memcpy( data( ), other.data( ), count * sizeof( limb_type ) );
+    }
+
+
+    BigInt::LimbBuffer::LimbBuffer( LimbBuffer &&other ) noexcept :
+        count( other.count ), capacity( other.capacity )
+    {
+        // A heap buffer can just be stolen. A local buffer has to be copied, but it is small.
+        if( other.on_heap( ) ) {
+            heap = other.heap;
+            other.capacity = inline_capacity;
+        }
+        else {
+            std::memcpy( local, other.local, count * sizeof( limb_type ) );
+        }
+        other.count = 0;
+    }
+
+
+    BigInt::LimbBuffer &BigInt::LimbBuffer::operator=( const LimbBuffer &other )
+    {
+        if( this != &other ) {
+            // Reuse the existing storage if it is big enough.
+            count = 0;
+            reserve( other.count );
+            count = other.count;
+            std::memcpy( data( ), other.data( ), count * sizeof( limb_type ) );
+        }
+        return *this;
+    }
+
+
+    BigInt::LimbBuffer &BigInt::LimbBuffer::operator=( LimbBuffer &&other ) noexcept
+    {
+        if( this != &other ) {
+            if( other.on_heap( ) ) {
+                if( on_heap( ) ) release( heap, capacity );
+                heap     = other.heap;
+                capacity = other.capacity;
+                other.capacity = inline_capacity;
+            }
+            else {
+                // The other value is small so it fits in whatever storage this buffer has.
+                std::memcpy( data( ), other.local, other.count * sizeof( limb_type ) );
+            }
+            count = other.count;
+            other.count = 0;
+        }
+        return *this;
+    }
+
+
+    void BigInt::LimbBuffer::resize( std::size_t new_count, limb_type value )
+    {
+        reserve( new_count );
+        if( new_count > count ) {
+            std::fill( data( ) + count, data( ) + new_count, value );
+        }
+        count = static_cast<std::uint32_t>( new_count );
+    }
+
+
+    //
+    // BigInt::LimbBuffer::grow
+    //
+    // Moves the limbs into a heap buffer with room for at least minimum limbs. The capacity
+    // grows geometrically so that a sequence of push_back operations takes linear time overall.
+    //
+    void BigInt::LimbBuffer::grow( std::size_t minimum )
+    {
+        std::size_t new_capacity = std::max<std::size_t>( minimum, 2 * capacity );
+        limb_type *new_heap = allocate( new_capacity );
+        std::memcpy( new_heap, data( ), count * sizeof( limb_type ) );
+        if( on_heap( ) ) release( heap, capacity );
+        heap     = new_heap;
+        capacity = static_cast<std::uint32_t>( new_capacity );
+    }
+
+
+    //------------------------------------
+    //               BigInt
+    //------------------------------------
+
+    std::pmr::memory_resource *BigInt::memory_resource( )
+    {
+        return current_resource;
+    }
+
+
+    std::pmr::memory_resource *BigInt::set_memory_resource( std::pmr::memory_resource *resource )
+    {
+        std::pmr::memory_resource *previous = current_resource;
+        current_resource = resource;
+        return previous;
+    }
+
+
+    //
+    // BigInt::normalize
+    //
+    // This function removes any leading zero limbs. Every operation that might shrink the
+    // magnitude of a BigInt must call this before returning. Zero is always given a positive
+    // sign so that there is only one representation of it.
+    //
+    void BigInt::normalize( )
+    {
+        while( !limbs.empty( ) && limbs.back( ) == 0 ) {
+            limbs.pop_back( );
+        }
+        if( limbs.empty( ) ) sign = 1;
+    }
+
+
+    //
+    // BigInt::magnitude64
+    // BigInt::set_magnitude
+    //
+    // These move a small magnitude between the limbs and native integers. The magnitude given
+    // to set_magnitude is high * 2^64 + low, which takes at most four limbs. It fits in the
+    // local buffer, so neither function ever allocates.
+    //
+    BigInt::wide_type BigInt::magnitude64( ) const
+    {
+        const limb_type *p = limbs.data( );
+        switch( limbs.size( ) ) {
+        case 0:  return 0;
+        case 1:  return p[0];
+        default: return ( static_cast<wide_type>( p[1] ) << 32 ) | p[0];
+        }
+    }
+
+
+    void BigInt::set_magnitude( int new_sign, wide_type low, wide_type high )
+    {
+        limb_type *p = limbs.data( );
+        p[0] = static_cast<limb_type>( low );
+        p[1] = static_cast<limb_type>( low >> 32 );
+        p[2] = static_cast<limb_type>( high );
+        p[3] = static_cast<limb_type>( high >> 32 );
+
+        std::size_t count;
+        if( high != 0 ) count = ( high >> 32 != 0 ) ? 4 : 3;
+        else count = ( low >> 32 != 0 ) ? 2 : ( low != 0 ) ? 1 : 0;
+        limbs.set_size( count );
+        sign = ( count == 0 ) ? 1 : new_sign;
+    }
+
+
+    //
+    // BigInt::set_sum
+    //
+    // Sets this object to the sum of two signed 64 bit magnitudes. A carry out of the sum shows
+    // up as the sum wrapping around to less than an operand.
+    //
+    void BigInt::set_sum( int left_sign, wide_type left, int right_sign, wide_type right )
+    {
+        if( left_sign == right_sign ) {
+            const wide_type sum = left + right;
+            set_magnitude( left_sign, sum, sum < left );
+        }
+        else if( left >= right ) {
+            set_magnitude( left_sign, left - right );
+        }
+        else {
+            set_magnitude( right_sign, right - left );
+        }
+    }
+
+
     //
     // BigInt::BigInt
     //
@@ -20,11 +252,7 @@ namespace vtsu {
     //
     BigInt::BigInt( )
     {
-        sign = 1;  // Zero is positive.
-
-        for( int i = 0; i < 256; i++ ) {
-            digits[i] = 0;
-        }
+        sign = 1;  // Zero is positive. The limb buffer is empty.
     }
 
 
@@ -36,57 +264,264 @@ namespace vtsu {
     //
     BigInt::BigInt( long number )
     {
-        int i;
+        // The magnitude is computed in unsigned arithmetic so that the most negative value,
+        // which has no positive representation as a long, is handled correctly.
+        //
+        unsigned long magnitude = static_cast<unsigned long>( number );
+        if( number < 0 ) magnitude = 0UL - magnitude;
+        set_magnitude( ( number < 0 ) ? -1 : 1, magnitude );
+    }
 
-        // Set the sign flag appropriately. Make sure number is positive.
-        sign = 1;
-        if( number < 0 ) {
-            sign = -1;
-            number = -number;   // TODO: The most negative value has no positive representation.
+
+    //
+    // bool BigInt::fits_int64( ) const
+    // std::int64_t BigInt::to_int64( ) const
+    //
+    // The range of std::int64_t is not symmetric. A negative value may have a magnitude one
+    // larger than the largest positive value.
+    //
+    bool BigInt::fits_int64( ) const
+    {
+        if( limbs.size( ) > native_limbs ) return false;
+        const wide_type limit = static_cast<wide_type>( INT64_MAX ) + ( sign < 0 ? 1 : 0 );
+        return magnitude64( ) <= limit;
+    }
+
+
+    std::int64_t BigInt::to_int64( ) const
+    {
+        if( !fits_int64( ) ) {
+            throw std::overflow_error( "BigInt: value does not fit in 64 bits" );
+        }
+        // Negating in unsigned arithmetic and then converting handles INT64_MIN correctly.
+        const wide_type magnitude = magnitude64( );
+        return static_cast<std::int64_t>( sign < 0 ? 0 - magnitude : magnitude );
+    }
+
+
+    //
+    // void BigInt::add_signed( const BigInt &, int )
+    //
+    // If the two signs are the same, the magnitudes are added and the sign is left alone.
+    // Otherwise the smaller magnitude is subtracted from the larger one and the result takes the
+    // sign of the larger. The loops themselves are the add and subtract kernels in
+    // BigIntKernels.hpp. They only run over the limbs actually in use. When both values are
+    // small the kernels are skipped in favor of native 64 bit arithmetic.
+    //
+    // Notice that right might be the same object as *this (as in x += x). The resize operations
+    // below can move the limbs of *this to new memory, so the data pointer of right is only
+    // fetched after all resizing is done.
+    //
+    void BigInt::add_signed( const BigInt &right, int right_sign )
+    {
+        const std::size_t left_size  = limbs.size( );
+        const std::size_t right_size = right.limbs.size( );
+
+        if( right_size == 0 ) return;
+        if( left_size == 0 ) {
+            *this = right;
+            sign = right_sign;
+            return;
         }
 
-        // Zero out ALL the digits to start.
-        for( i = 0; i < 256; i++ ) {
-            digits[i] = 0;
+        if( left_size <= native_limbs && right_size <= native_limbs ) {
+            set_sum( sign, magnitude64( ), right_sign, right.magnitude64( ) );
+            return;
         }
 
-        // Now get the individual digits of number, one at a time.
-        i = 0;
-        while( number != 0 ) {
-            digits[i] = static_cast<short>( number % 10 );
-            i++;
-            number /= 10;
+        if( sign == right_sign ) {
+            // The sum is at most one limb longer than the longest operand.
+            if( left_size >= right_size ) {
+                limbs.resize( left_size + 1 );
+                limbs[left_size] = kernels::add(
+                    limbs.data( ), limbs.data( ), left_size, right.limbs.data( ), right_size );
+            }
+            else {
+                limbs.resize( right_size + 1 );
+                limbs[right_size] = kernels::add(
+                    limbs.data( ), right.limbs.data( ), right_size, limbs.data( ), left_size );
+            }
+        }
+        else {
+            int order = kernels::compare(
+                limbs.data( ), left_size, right.limbs.data( ), right_size );
+            if( order == 0 ) {
+                limbs.clear( );
+            }
+            else if( order > 0 ) {
+                kernels::sub(
+                    limbs.data( ), limbs.data( ), left_size, right.limbs.data( ), right_size );
+            }
+            else {
+                // |right| > |left| so compute right - left in place. The left operand is first
+                // extended with zeros to the length of the right operand.
+                //
+                limbs.resize( right_size );
+                kernels::sub_n( limbs.data( ), right.limbs.data( ), limbs.data( ), right_size );
+                sign = right_sign;
+            }
         }
+        normalize( );
     }
 
 
     //
     // void BigInt::operator+=( const BigInt & )
+    // void BigInt::operator-=( const BigInt & )
     //
-    // This function adds the right operand into the implicit object It will eventually handle
-    // negative numbers correctly as well.
+    // These functions add (or subtract) the right operand into the implicit object. Negative
+    // numbers are fully supported.
     //
-    void BigInt::operator+=(const BigInt &right)
+    void BigInt::operator+=( const BigInt &right )
     {
-        // If both operands are positive or if both are negative, we just add their absolute
-        // values and leave the sign alone. Notice below how I access the left operand's members
-        // directly and the right operands members using the dot operator.
-        //
-        if( sign == right.sign ) {
-            short sum, carry = 0;
-            for( int i = 0; i < 256; i++ ) {
-                sum       = digits[i] + right.digits[i] + carry;
-                digits[i] = sum % 10;
-                carry     = sum / 10;
-            }
-            // TODO: Add overflow checking!
+        add_signed( right, right.sign );
+    }
+
+
+    void BigInt::operator-=( const BigInt &right )
+    {
+        add_signed( right, -right.sign );
+    }
+
+
+    //
+    // void BigInt::assign_sum( const BigInt &, const BigInt &, int )
+    //
+    // This is used to evaluate expressions such as a + b. For small values it saves copying
+    // the left operand into this object before adding.
+    //
+    void BigInt::assign_sum( const BigInt &left, const BigInt &right, int right_sign )
+    {
+        if( left.limbs.size( ) <= native_limbs && right.limbs.size( ) <= native_limbs ) {
+            set_sum( left.sign, left.magnitude64( ), right_sign, right.magnitude64( ) );
+            return;
         }
+        *this = left;
+        add_signed( right, right_sign );
+    }
 
-        // The signs are different. In that case I really need to subtract.
-        else {
-            std::cerr << "BigInt::operator+=( ): "
-                "Addition of unlike signs not yet implemented!\n";
+
+    //
+    // void BigInt::operator*=( const BigInt & )
+    //
+    // This function multiplies the implicit object by the right operand. The real work is done
+    // by the multiplication engine in BigIntMultiply.cpp. The product is built in a separate
+    // buffer because the engine can't overwrite its own inputs (consider x *= x).
+    //
+    void BigInt::operator*=( const BigInt &right )
+    {
+        if( limbs.empty( ) || right.limbs.empty( ) ) {
+            limbs.clear( );
+            sign = 1;
+            return;
         }
+        if( limbs.size( ) <= native_limbs && right.limbs.size( ) <= native_limbs ) {
+            wide_type high;
+            wide_type low = kernels::multiply_wide( magnitude64( ), right.magnitude64( ), high );
+            set_magnitude( sign * right.sign, low, high );
+            return;
+        }
+
+        LimbBuffer product;
+        product.resize( limbs.size( ) + right.limbs.size( ) );
+        kernels::multiply( product.data( ),
+            limbs.data( ), limbs.size( ), right.limbs.data( ), right.limbs.size( ) );
+        limbs = std::move( product );
+        sign *= right.sign;
+        normalize( );
+    }
+
+
+    //
+    // void BigInt::assign_product( const BigInt &, const BigInt & )
+    //
+    // This is like operator*= except that the product is built directly in this object's
+    // buffer. If the buffer is already big enough, as it usually is when the same variable is
+    // assigned products over and over, no memory is allocated.
+    //
+    void BigInt::assign_product( const BigInt &left, const BigInt &right )
+    {
+        limbs.clear( );
+        sign = 1;
+        if( left.limbs.empty( ) || right.limbs.empty( ) ) return;
+        if( left.limbs.size( ) <= native_limbs && right.limbs.size( ) <= native_limbs ) {
+            wide_type high;
+            wide_type low = kernels::multiply_wide( left.magnitude64( ), right.magnitude64( ), high );
+            set_magnitude( left.sign * right.sign, low, high );
+            return;
+        }
+
+        limbs.resize( left.limbs.size( ) + right.limbs.size( ) );
+        kernels::multiply( limbs.data( ),
+            left.limbs.data( ), left.limbs.size( ), right.limbs.data( ), right.limbs.size( ) );
+        sign = left.sign * right.sign;
+        normalize( );
+    }
+
+
+    //
+    // void BigInt::operator/=( const BigInt & )
+    // void BigInt::operator%=( const BigInt & )
+    //
+    // Both of these are done with divmod (see below). The division algorithms produce the
+    // quotient and the remainder together anyway.
+    //
+    void BigInt::operator/=( const BigInt &right )
+    {
+        *this = std::move( divmod( *this, right ).first );
+    }
+
+
+    void BigInt::operator%=( const BigInt &right )
+    {
+        *this = std::move( divmod( *this, right ).second );
+    }
+
+
+    //
+    // std::pair<BigInt, BigInt> divmod( const BigInt &, const BigInt & )
+    //
+    // This function divides the dividend by the divisor and returns the quotient and the
+    // remainder. The work is done by the division engine in BigIntDivide.cpp, which works on
+    // magnitudes. The signs are sorted out here.
+    //
+    std::pair<BigInt, BigInt> divmod( const BigInt &dividend, const BigInt &divisor )
+    {
+        if( divisor.limbs.empty( ) ) {
+            throw std::domain_error( "BigInt: division by zero" );
+        }
+
+        std::pair<BigInt, BigInt> result;
+        BigInt &quotient  = result.first;
+        BigInt &remainder = result.second;
+
+        const std::size_t an = dividend.limbs.size( );
+        const std::size_t bn = divisor.limbs.size( );
+
+        // If the dividend is smaller than the divisor the quotient is zero.
+        if( kernels::compare( dividend.limbs.data( ), an, divisor.limbs.data( ), bn ) < 0 ) {
+            remainder = dividend;
+            return result;
+        }
+
+        if( an <= BigInt::native_limbs ) {
+            const BigInt::wide_type a = dividend.magnitude64( );
+            const BigInt::wide_type b = divisor.magnitude64( );
+            quotient.set_magnitude( dividend.sign * divisor.sign, a / b );
+            remainder.set_magnitude( dividend.sign, a % b );
+            return result;
+        }
+
+        quotient.limbs.resize( an - bn + 1 );
+        remainder.limbs.resize( bn );
+        kernels::divide( quotient.limbs.data( ), remainder.limbs.data( ),
+            dividend.limbs.data( ), an, divisor.limbs.data( ), bn );
+
+        quotient.sign  = dividend.sign * divisor.sign;
+        remainder.sign = dividend.sign;
+        quotient.normalize( );
+        remainder.normalize( );
+        return result;
     }
 
 
@@ -100,13 +535,10 @@ namespace vtsu {
         // To be equal, they must have the same sign.
         if( left.sign != right.sign ) return false;
 
-        // They must also have all identical digits.
-        for( int i = 0; i < 256; i++ ) {
-            if( left.digits[i] != right.digits[i] ) return false;
-        }
-        
-        // If I get here, they must be equal.
-        return true;
+        // They must also have all identical limbs. Because neither value has leading zeros,
+        // numbers of different lengths can't possibly be equal.
+        //
+        return left.limbs == right.limbs;
     }
 
     //
@@ -116,63 +548,160 @@ namespace vtsu {
     //
     bool operator<( const BigInt &left, const BigInt &right )
     {
-        if( left.sign < right.sign ) return true;
-        if( left.sign > right.sign ) return false;
+        return compare( left, right ) < 0;
+    }
+
+
+    //
+    // int compare( const BigInt &, const BigInt & )
+    //
+    int compare( const BigInt &left, const BigInt &right )
+    {
         // Here I use the fact that -1 < 1 to check for situations where the two numbers have a
-        // different sign. After getting through this the two numbers must have the same sign.
-
-        if( left.sign == 1 ) {
-            // The two numbers are both positive.
-            for( int i = 255; i >=0; i-- ) {
-                if( left.digits[i] < right.digits[i] ) return true;
-                if( left.digits[i] > right.digits[i] ) return false;
-                // Otherwise these two digits are equal. Let's try the next pair.
-            }
-        }
-        else {
-            // The two numbers are both negative.
-            for( int i = 255; i >=0; i-- ) {
-                if( left.digits[i] < right.digits[i] ) return false;
-                if( left.digits[i] > right.digits[i] ) return true;
-                // Otherwise these two digits are equal. Let's try the next pair.
-            }
-        }
+        // different sign. Since zero is always positive, it is handled correctly too.
+        //
+        if( left.sign != right.sign ) return ( left.sign < right.sign ) ? -1 : 1;
 
-        // If I get here the two numbers must have had all equal digits.
-        return false;
+        // Compare the magnitudes. The number with more limbs has the larger magnitude.
+        // Otherwise scan from the most significant limb down until a difference is found. For
+        // negative numbers the larger magnitude is the smaller value.
+        //
+        return left.sign * kernels::compare(
+            left.limbs.data( ), left.limbs.size( ), right.limbs.data( ), right.limbs.size( ) );
     }
 
-  
-    // 
-    // std::ostream &operator<<( std::ostream &os, const BigInt &right )
+
+    //
+    // std::size_t BigInt::hash( ) const
     //
-    // This function writes a BigInt into the given output stream. It properly displays a
-    // negative sign, if appropriate. However, it does not deal with the stream's formatting
-    // state very well.
+    // The limbs are mixed in two at a time with a multiply and rotate, then the result is
+    // scrambled with the finalizer from MurmurHash3 so that every bit of the value affects
+    // every bit of the hash.
     //
-    std::ostream &operator<<( std::ostream &os, const BigInt &right )
+    std::size_t BigInt::hash( ) const
     {
-        int i;
+        const std::uint64_t multiplier = 0x9E3779B97F4A7C15ULL;
+        const limb_type *p = limbs.data( );
+        const std::size_t n = limbs.size( );
 
-        // Print a minus sign if the number is negative.
-        if( right.sign == -1 ) os << "-";
-
-        // Find the first non-zero digit.
-        for( i = 255; i >= 0; i-- ) {
-            if( right.digits[i] != 0 ) break;
+        std::uint64_t h = static_cast<std::uint64_t>( n ) * 2 + ( sign < 0 ? 1 : 0 );
+        std::size_t i = 0;
+        for( ; i + 1 < n; i += 2 ) {
+            std::uint64_t word = ( static_cast<std::uint64_t>( p[i + 1] ) << 32 ) | p[i];
+            h = ( h ^ word ) * multiplier;
+            h = ( h << 31 ) | ( h >> 33 );
         }
+        if( i < n ) h = ( ( h ^ p[i] ) * multiplier );
+
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ULL;
+        h ^= h >> 33;
+        return static_cast<std::size_t>( h );
+    }
+
+
+    //------------------------------------
+    //            BigIntArena
+    //------------------------------------
+
+    namespace {
+
+        const std::size_t chunk_size       = 64 * 1024;
+        const std::size_t chunk_cache_size = 64;  // Keep at most this many spare chunks.
 
-        // If the above loop didn't break, then there were no non-zero digits. Thus the number
-        // is 0.
+        // Standard size chunks that aren't being used by any arena. Each thread has its own
+        // list, so no locking is needed. The chunks are released when the thread ends.
         //
-        if( i == -1 ) os << "0";
-        else {
-            // Print the number, one digit at a time.
-            while( i >= 0 ) {
-                os << right.digits[i];
-                i--;
+        struct ChunkCache {
+            std::vector<void *> chunks;
+           ~ChunkCache( ) { for( void *chunk : chunks ) ::operator delete( chunk ); }
+        };
+
+        thread_local ChunkCache chunk_cache;
+
+    } // End of anonymous namespace
+
+
+    BigIntArena::BigIntArena( ) :
+        chunks( nullptr ), position( nullptr ), end( nullptr ), previous( nullptr )
+    {
+        previous = BigInt::set_memory_resource( this );
+    }
+
+
+    BigIntArena::~BigIntArena( )
+    {
+        BigInt::set_memory_resource( previous );
+        while( chunks != nullptr ) {
+            Chunk *next = chunks->next;
+            if( chunks->size == chunk_size && chunk_cache.chunks.size( ) < chunk_cache_size ) {
+                chunk_cache.chunks.push_back( chunks );
+            }
+            else {
+                ::operator delete( chunks );
+            }
+            chunks = next;
+        }
+    }
+
+
+    //
+    // void *BigIntArena::do_allocate( std::size_t, std::size_t )
+    //
+    // Memory is taken from the current chunk. When the chunk is full a new one is started; the
+    // rest of the old one is wasted. A request too large for a standard chunk gets a chunk of
+    // its own.
+    //
+    void *BigIntArena::do_allocate( std::size_t bytes, std::size_t alignment )
+    {
+        std::size_t padding = ( alignment - reinterpret_cast<std::uintptr_t>( position ) % alignment )
+            % alignment;
+        if( position == nullptr || static_cast<std::size_t>( end - position ) < padding + bytes ) {
+            std::size_t size = std::max( chunk_size, sizeof( Chunk ) + bytes + alignment );
+            void *memory;
+            if( size == chunk_size && !chunk_cache.chunks.empty( ) ) {
+                memory = chunk_cache.chunks.back( );
+                chunk_cache.chunks.pop_back( );
+            }
+            else {
+                memory = ::operator new( size );
             }
+            Chunk *chunk = static_cast<Chunk *>( memory );
+            chunk->next = chunks;
+            chunk->size = size;
+            chunks   = chunk;
+            position = reinterpret_cast<char *>( chunk + 1 );
+            end      = reinterpret_cast<char *>( chunk ) + size;
+            padding  = ( alignment - reinterpret_cast<std::uintptr_t>( position ) % alignment )
+                % alignment;
+        }
+        void *result = position + padding;
+        position += padding + bytes;
+        return result;
+    }
+
+
+    //
+    // BigInt BigIntArena::keep( const BigInt & ) const
+    //
+    // The copy is made while the resource that was in use before the arena was created is
+    // current. If this arena is nested in another, the copy goes into the outer one.
+    //
+    BigInt BigIntArena::keep( const BigInt &value ) const
+    {
+        std::pmr::memory_resource *current = BigInt::set_memory_resource( previous );
+        BigInt copy;
+        try {
+            copy = value;
+        }
+        catch( ... ) {
+            BigInt::set_memory_resource( current );
+            throw;
         }
+        BigInt::set_memory_resource( current );
+        return copy;
     }
 
 } // End of namespace vtsu
@@ -17,60 +17,593 @@ normal integers but they can hold far larger values.
 // once by the compiler. If the compiler processes this header multiple times, there might be
 // errors.
 
+#include <cstdint>
 #include <iosfwd>
 // This header contains forward declarations of the classes std::ostream and std::istream
 // without bringing in all the gory details of the iostreams header. It thus compiles faster and
 // is the better choice when one only wants to declare references (or pointers) to certain
 // stream classes.
 
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <memory_resource>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 namespace vtsu {
 
+    template<class Operation, class Left, class Right> class BigIntExpression;
+
     class BigInt {
 
-        // I/O operations.
+        // I/O operations. These honor the stream's basefield flags (dec, hex, or oct) and, for
+        // output, the field width.
+        //
         friend std::ostream &operator<<( std::ostream &, const BigInt & );
         friend std::istream &operator>>( std::istream &, BigInt & );
 
-        // Relational operators.
+        // Relational operators. The function compare returns -1, 0, or +1 if the left operand
+        // is less than, equal to, or greater than the right operand. Numbers with different
+        // signs or lengths are ordered without looking at their limbs.
+        //
         friend bool operator==( const BigInt &, const BigInt & );
         friend bool operator< ( const BigInt &, const BigInt & );
+        friend int  compare( const BigInt &, const BigInt & );
+
+        // Division. Returns the quotient and the remainder together. This is much faster than
+        // using / and % separately when both are needed.
+        friend std::pair<BigInt, BigInt> divmod( const BigInt &, const BigInt & );
+
+        // Returns the product of the values in [first, last), or one if the range is empty.
+        friend BigInt product( const BigInt *first, const BigInt *last );
+
+        friend class BigIntModulus;
+        template<class Operation, class Left, class Right> friend class BigIntExpression;
 
     public:
+        // A BigInt is stored as a sequence of "limbs." Each limb is a single digit in base 2^32.
+        // The wide type is large enough to hold the product of two limbs (plus a carry) so that
+        // the arithmetic loops never lose information.
+        //
+        typedef std::uint32_t limb_type;
+        typedef std::uint64_t wide_type;
+
         // Default constructor.
         BigInt( );
 
         // Allows a BigInt to be initialized with a normal int.
         BigInt( long number );
 
+        // Allows a BigInt to be initialized with (or assigned) an expression such as
+        // a*b + c*d - e. The expression is evaluated directly into this object (see
+        // BigIntExpression below).
+        //
+        template<class Operation, class Left, class Right>
+        BigInt( const BigIntExpression<Operation, Left, Right> &expression );
+
+        template<class Operation, class Left, class Right>
+        BigInt &operator=( const BigIntExpression<Operation, Left, Right> &expression );
+
+        // Conversions to and from text. The base can be 2, 8, 10, or 16. Power of two bases take
+        // linear time. Base 10 uses divide and conquer with cached powers of ten so that even
+        // numbers with millions of digits convert quickly. The text is an optional sign followed
+        // by one or more digits (letters for hex digits can be in either case). The function
+        // from_string throws std::invalid_argument if the text is not of that form.
+        //
+        std::string   to_string( int base = 10 ) const;
+        static BigInt from_string( const std::string &text, int base = 10 );
+
+        // Conversion to a native integer. The function fits_int64 returns true if the value is
+        // in the range of std::int64_t. The function to_int64 returns the value and throws
+        // std::overflow_error if it isn't.
+        //
+        bool         fits_int64( ) const;
+        std::int64_t to_int64( ) const;
+
+        // Returns a hash of the value. Equal values have equal hashes. See also std::hash below.
+        std::size_t hash( ) const;
+
+        // The storage for large values comes from a memory resource. Each thread has its own
+        // current resource, which is used for every allocation that thread makes. Initially it
+        // is null, meaning that the global operator new is used. Storage is always returned to
+        // the resource it came from, no matter which resource is current at the time. Setting
+        // the resource returns the previous one. Any std::pmr resource can be used; for
+        // example, a std::pmr::unsynchronized_pool_resource gives each thread a pool of
+        // blocks sorted by size. See also BigIntArena below.
+        //
+        static std::pmr::memory_resource *memory_resource( );
+        static std::pmr::memory_resource *set_memory_resource( std::pmr::memory_resource *resource );
+
         void operator+=( const BigInt & );
         void operator-=( const BigInt & );
         void operator*=( const BigInt & );
         void operator/=( const BigInt & );
         void operator%=( const BigInt & );
-        // All the usual math operations.
-        
+        // All the usual math operations. Division truncates toward zero and the remainder has
+        // the same sign as the dividend, just as for the built in integer types. Dividing by
+        // zero throws std::domain_error.
+
     private:
-        int   sign;          // -1 for negative, +1 for zero or positive.
-        short digits[256];   // digits[0] is the least significant digit.
-        // The value 256 should not be hard coded here. Instead a constant needs to be created
-        // and used consistently. In BigInt.cpp there are many places where '256' or '255'
-        // appear that would need to be edited if it is later decided to change the size of the
-        // digits array.
+
+        // A LimbBuffer is a minimal vector of limbs with a "small buffer optimization." Values
+        // of up to inline_capacity limbs (128 bits) are stored directly inside the BigInt object
+        // itself. Only larger values spill over into memory obtained from the heap. Since most
+        // numbers in practice are small, this means that most BigInt objects never allocate
+        // anything, and copying or moving them is just a matter of copying a few words.
+        //
+        class LimbBuffer {
+        public:
+            static const std::uint32_t inline_capacity = 4;
+
+            LimbBuffer( ) : count( 0 ), capacity( inline_capacity ) { }
+            LimbBuffer( const LimbBuffer &other );
+            LimbBuffer( LimbBuffer &&other ) noexcept;
+            LimbBuffer &operator=( const LimbBuffer &other );
+            LimbBuffer &operator=( LimbBuffer &&other ) noexcept;
+           ~LimbBuffer( ) { if( on_heap( ) ) release( heap, capacity ); }
+
+            std::size_t size( ) const  { return count; }
+            bool        empty( ) const { return count == 0; }
+            bool        on_heap( ) const { return capacity > inline_capacity; }
+
+            limb_type       *data( )       { return on_heap( ) ? heap : local; }
+            const limb_type *data( ) const { return on_heap( ) ? heap : local; }
+
+            limb_type       &operator[]( std::size_t i )       { return data( )[i]; }
+            const limb_type &operator[]( std::size_t i ) const { return data( )[i]; }
+
+            limb_type back( ) const { return data( )[count - 1]; }
+            void      pop_back( )   { --count; }
+            void      clear( )      { count = 0; }
+
+            void push_back( limb_type value )
+            {
+                if( count == capacity ) grow( count + 1 );
+                data( )[count++] = value;
+            }
+
+            // Changes the number of limbs. New limbs, if any, are set to value.
+            void resize( std::size_t new_count, limb_type value = 0 );
+
+            // Changes the number of limbs without initializing any new ones. The new count must
+            // not exceed the capacity, which is always at least inline_capacity.
+            //
+            void set_size( std::size_t new_count ) { count = static_cast<std::uint32_t>( new_count ); }
+
+            // Ensures room for at least new_capacity limbs without changing the contents.
+            void reserve( std::size_t new_capacity )
+                { if( new_capacity > capacity ) grow( new_capacity ); }
+
+            friend bool operator==( const LimbBuffer &left, const LimbBuffer &right )
+            {
+                return left.count == right.count &&
+                    std::memcmp( left.data( ), right.data( ), left.count * sizeof( limb_type ) ) == 0;
+            }
+
+        private:
+            std::uint32_t count;     // Number of limbs in use.
+            std::uint32_t capacity;  // Number of limbs available (inline_capacity if not on heap).
+            union {
+                limb_type  local[inline_capacity];
+                limb_type *heap;
+            };
+
+            void grow( std::size_t minimum );
+            static limb_type *allocate( std::size_t limb_count );
+            static void release( limb_type *pointer, std::size_t limb_count );
+        };
+
+        int        sign;    // -1 for negative, +1 for zero or positive.
+        LimbBuffer limbs;   // limbs[0] is the least significant limb.
+        // The buffer only holds as many limbs as the magnitude actually needs; there are never
+        // any leading zero limbs. Zero is represented by an empty buffer. Keeping the
+        // representation normalized this way means that the cost of every operation depends on
+        // the size of the values involved rather than on some fixed capacity.
+
+        void normalize( );  // Removes leading zero limbs and fixes the sign of zero.
+
+        // Adds right (taken to have the sign right_sign) to this object. This does the work for
+        // both += and -=.
+        //
+        void add_signed( const BigInt &right, int right_sign );
+
+        // Values of at most two limbs fit in a 64 bit native integer, and so does the sum or
+        // difference of two of them apart from a carry. Such values are added, multiplied, and
+        // divided with native arithmetic instead of the limb kernels (see BigInt.cpp).
+        //
+        static const std::size_t native_limbs = 2;
+
+        wide_type magnitude64( ) const;  // Requires limbs.size( ) <= native_limbs.
+        void set_magnitude( int new_sign, wide_type low, wide_type high = 0 );
+        void set_sum( int left_sign, wide_type left, int right_sign, wide_type right );
+
+        // Sets this object to left + right (taken to have the sign right_sign) or left * right,
+        // reusing its storage. Neither operand may be this object.
+        //
+        void assign_sum( const BigInt &left, const BigInt &right, int right_sign );
+        void assign_product( const BigInt &left, const BigInt &right );
+
+        // Helpers for base 10 conversion (see BigIntRadix.cpp).
+        static void   write_decimal( std::string &text, const BigInt &value, std::size_t width );
+        static BigInt read_decimal( const limb_type *chunks, std::size_t count );
     };
 
 
-    // The binary math operators are easily expressed in terms of the in place operators
-    // declared above.
     //
-    inline BigInt operator+( const BigInt &left, const BigInt &right )
-        { BigInt temp( left ); temp += right; return temp; }
+    // BigIntArena
+    //
+    // While a BigIntArena exists, the thread that created it takes all BigInt storage from
+    // the arena. Taking memory from an arena just advances a pointer, and giving it back does
+    // nothing at all. Everything is released at once when the arena is destroyed. This makes
+    // a computation that creates and destroys millions of temporary values much faster.
+    //
+    // Every value that got storage from the arena must be destroyed before the arena is. This
+    // includes values that existed before the arena was created but grew while it was active.
+    // Use keep to copy a result out of the arena. Arenas can be nested. They must be
+    // destroyed in the reverse order of their creation, which happens naturally when they are
+    // local variables.
+    //
+    class BigIntArena : public std::pmr::memory_resource {
+    public:
+        BigIntArena( );
+       ~BigIntArena( );
+
+        BigIntArena( const BigIntArena & ) = delete;
+        BigIntArena &operator=( const BigIntArena & ) = delete;
 
-    inline BigInt operator-( const BigInt &left, const BigInt &right )
-        { BigInt temp( left ); temp -= right; return temp; }
+        // Returns a copy of value whose storage doesn't come from this arena.
+        BigInt keep( const BigInt &value ) const;
+
+    private:
+        // The arena's memory is a list of chunks. Chunks of the standard size are kept in a
+        // per-thread cache when an arena is destroyed so that the next arena can reuse them
+        // without going back to the operating system (see BigInt.cpp).
+        //
+        struct Chunk {
+            Chunk      *next;
+            std::size_t size;  // Total size of the chunk, including this header.
+        };
+
+        Chunk *chunks;    // The chunks in use, most recent first.
+        char  *position;  // The next free byte of the most recent chunk.
+        char  *end;       // The end of the most recent chunk.
+        std::pmr::memory_resource *previous;  // The resource to restore when finished.
+
+        void *do_allocate( std::size_t bytes, std::size_t alignment ) override;
+        void  do_deallocate( void *, std::size_t, std::size_t ) override { }
+        bool  do_is_equal( const std::pmr::memory_resource &other ) const noexcept override
+            { return this == &other; }
+    };
+
+
+    // Tuning parameters for the BigInt algorithms. Each threshold is an operand size, in limbs,
+    // at which an asymptotically faster algorithm takes over from a simpler one. The best values
+    // depend on the machine; the defaults were chosen by running BigIntBench. The thresholds
+    // can be changed at any time but not while other threads are using BigInt.
+    //
+    // Multiplications with operands of at least parallel_threshold limbs split their work
+    // among thread_count threads. A thread count of zero means one thread per processor core.
+    // The thread pool is created the first time it is needed, and changing thread_count after
+    // that only matters if it is set to one, which turns threading off.
+    //
+    struct BigIntTuning {
+        static std::size_t karatsuba_threshold;  // Schoolbook multiplication below this.
+        static std::size_t toom3_threshold;      // Karatsuba multiplication below this.
+        static std::size_t ntt_threshold;        // Toom-3 multiplication below this.
+        static std::size_t burnikel_ziegler_threshold;  // Algorithm D division below this.
+        static std::size_t radix_threshold;      // Quadratic base 10 conversion below this.
+        static std::size_t montgomery_threshold; // Word by word Montgomery reduction below this.
+        static std::size_t parallel_threshold;   // Single threaded multiplication below this.
+        static unsigned    thread_count;         // Number of threads to use.
+    };
+
+
+    std::pair<BigInt, BigInt> divmod( const BigInt &dividend, const BigInt &divisor );
+
+
+    // Products of many values. The factors are multiplied in a balanced tree: first in pairs,
+    // then the pairs in pairs, and so on. This way the big multiplications are between numbers
+    // of about the same size, where the fast algorithms work best. The two halves of a large
+    // tree are computed in parallel (see BigIntTuning).
+    //
+    BigInt product( const BigInt *first, const BigInt *last );
+
+    inline BigInt product( const std::vector<BigInt> &factors )
+        { return product( factors.data( ), factors.data( ) + factors.size( ) ); }
+
+    // Returns n! = 1 * 2 * ... * n.
+    BigInt factorial( unsigned long n );
+
+    // Returns the binomial coefficient n choose k, or zero if k > n.
+    BigInt binomial( unsigned long n, unsigned long k );
+
+
+    // A BigIntModulus is a modulus together with some precomputed values that make arithmetic
+    // with that modulus fast. Reducing a product normally takes a full division. Here it takes
+    // Montgomery reduction if the modulus is odd, or Barrett reduction if it is even. Either
+    // way this is only multiplication. Setting up a BigIntModulus costs a few divisions, so
+    // create one and reuse it for all the arithmetic with the same modulus.
+    //
+    class BigIntModulus {
+    public:
+        // The modulus must be positive; otherwise std::domain_error is thrown.
+        explicit BigIntModulus( const BigInt &modulus );
+
+        const BigInt &modulus( ) const { return value; }
+
+        // Returns x mod the modulus. The result is always in the range [0, modulus).
+        BigInt reduce( const BigInt &x ) const;
+
+        // Returns left * right mod the modulus.
+        BigInt multiply( const BigInt &left, const BigInt &right ) const;
+
+        // Returns base^exponent mod the modulus. The exponent must not be negative; otherwise
+        // std::domain_error is thrown. This uses sliding window exponentiation.
+        BigInt pow( const BigInt &base, const BigInt &exponent ) const;
+
+    private:
+        typedef BigInt::limb_type limb_type;
+        typedef std::vector<limb_type> LimbVector;
+
+        // Values are processed as "residues," which are arrays of exactly size limbs. When
+        // Montgomery reduction is used, a residue holds x * R mod m rather than x itself. Here
+        // m is the modulus and R is B^size, where B is the limb base.
+        //
+        BigInt      value;        // The modulus.
+        std::size_t size;         // The number of limbs in the modulus.
+        bool        montgomery;   // True if Montgomery reduction is used.
+        limb_type   word_inverse; // -1/m mod B (Montgomery only).
+        LimbVector  inverse;      // -1/m mod R (Montgomery with large moduli only).
+        LimbVector  r_squared;    // R^2 mod m (Montgomery only).
+        LimbVector  reciprocal;   // floor(B^(2 * size) / m) (Barrett only).
+
+        // Scratch space must have scratch_size( ) limbs.
+        std::size_t scratch_size( ) const;
+
+        void   to_residue( limb_type *r, const BigInt &x, limb_type *scratch ) const;
+        BigInt from_residue( const limb_type *a, limb_type *scratch ) const;
+        void   multiply_residues(
+                   limb_type *r, const limb_type *a, const limb_type *b, limb_type *scratch ) const;
+        void   reduce_product( limb_type *r, limb_type *product, limb_type *scratch ) const;
+    };
+
+    // Returns base^exponent mod modulus. This is a convenience function that creates a
+    // BigIntModulus for one computation. Use BigIntModulus directly when the same modulus is
+    // used repeatedly.
+    //
+    BigInt pow_mod( const BigInt &base, const BigInt &exponent, const BigInt &modulus );
+
+
+    // These functions are friends of BigInt. They are also declared here so that they can be
+    // applied to expressions (see below), which convert to BigInt.
+    //
+    std::ostream &operator<<( std::ostream &, const BigInt & );
+    std::istream &operator>>( std::istream &, BigInt & );
+    bool operator==( const BigInt &, const BigInt & );
+    bool operator< ( const BigInt &, const BigInt & );
+    int  compare( const BigInt &, const BigInt & );
 
-    inline BigInt operator*( const BigInt &left, const BigInt &right )
-        { BigInt temp( left ); temp *= right; return temp; }
 
+    // The operators +, -, and * don't compute anything. Instead they return a small object that
+    // records the operation and its operands. The computation happens when the expression is
+    // finally assigned to a BigInt (or used to initialize one). At that point the whole
+    // expression is known, so it can be evaluated directly into the destination. For example
+    //
+    //     x = a*b + c*d - e;
+    //
+    // puts a*b into x, puts c*d into a single scratch value, and then adds and subtracts in
+    // place. The naive method would create a temporary for each operator, and x would not be
+    // able to reuse its existing storage. An expression can be used anywhere a BigInt is
+    // expected; it is converted to a BigInt as needed.
+    //
+    // The operands of an expression are stored by reference. This means an expression must be
+    // used before the end of the statement that creates it. In particular, don't say
+    //
+    //     auto sum = a + b;
+    //
+    // since sum would be an expression referring to a and b (possibly temporaries that no
+    // longer exist) rather than a BigInt. Write BigInt sum = a + b instead.
+    //
+
+    // The operations.
+    struct BigIntAdd {
+        static const bool is_product = false;
+        static const int  right_sign = 1;
+        static void apply( BigInt &result, const BigInt &right ) { result += right; }
+    };
+
+    struct BigIntSubtract {
+        static const bool is_product = false;
+        static const int  right_sign = -1;
+        static void apply( BigInt &result, const BigInt &right ) { result -= right; }
+    };
+
+    struct BigIntMultiply {
+        static const bool is_product = true;
+        static void apply( BigInt &result, const BigInt &right ) { result *= right; }
+    };
+
+
+    // The leaves of an expression. Every node of an expression can count how many times it
+    // refers to a given BigInt and report its leftmost BigInt. These are used to decide if an
+    // expression can be evaluated directly into a BigInt it refers to (see operator= below).
+    //
+    class BigIntReference {
+    public:
+        static const bool is_leaf = true;
+
+        BigIntReference( const BigInt &number ) : pointer( &number ) { }
+
+        const BigInt &value( ) const { return *pointer; }
+        void evaluate( BigInt &result, BigInt & ) const
+            { if( &result != pointer ) result = *pointer; }
+
+        std::size_t   references( const BigInt *number ) const { return number == pointer; }
+        const BigInt *leftmost( ) const { return pointer; }
+
+    private:
+        const BigInt *pointer;
+    };
+
+    // A constant appearing in an expression, such as the 1 in a + 1. It is small, so it is
+    // stored by value.
+    //
+    class BigIntConstant {
+    public:
+        static const bool is_leaf = true;
+
+        BigIntConstant( long number ) : number( number ) { }
+
+        const BigInt &value( ) const { return number; }
+        void evaluate( BigInt &result, BigInt & ) const { result = number; }
+
+        std::size_t   references( const BigInt * ) const { return 0; }
+        const BigInt *leftmost( ) const { return nullptr; }
+
+    private:
+        BigInt number;
+    };
+
+
+    //
+    // BigIntExpression
+    //
+    // An interior node of an expression: left Operation right. The evaluate function computes
+    // the node's value into result. It must be given a scratch BigInt for any subexpression
+    // on the right. The scratch is passed down the left side of the tree, so a chain such as
+    // a*b + c*d - e*f needs only one. The result may be referred to by the expression, but
+    // only as its leftmost operand.
+    //
+    template<class Operation, class Left, class Right>
+    class BigIntExpression {
+    public:
+        static const bool is_leaf = false;
+
+        BigIntExpression( const Left &left, const Right &right ) : left( left ), right( right ) { }
+
+        void evaluate( BigInt &result, BigInt &scratch ) const
+        {
+            if constexpr( Left::is_leaf && Right::is_leaf ) {
+                // Compute straight into the result instead of copying the left operand there
+                // first. This is only possible if the result isn't an operand.
+                //
+                if( &result != &left.value( ) && &result != &right.value( ) ) {
+                    if constexpr( Operation::is_product ) {
+                        result.assign_product( left.value( ), right.value( ) );
+                    }
+                    else {
+                        result.assign_sum(
+                            left.value( ), right.value( ), Operation::right_sign * right.value( ).sign );
+                    }
+                    return;
+                }
+            }
+
+            left.evaluate( result, scratch );
+            if constexpr( Right::is_leaf ) {
+                Operation::apply( result, right.value( ) );
+            }
+            else {
+                BigInt inner_scratch;
+                right.evaluate( scratch, inner_scratch );
+                Operation::apply( result, scratch );
+            }
+        }
+
+        std::size_t references( const BigInt *number ) const
+            { return left.references( number ) + right.references( number ); }
+
+        const BigInt *leftmost( ) const { return left.leftmost( ); }
+
+    private:
+        Left  left;
+        Right right;
+    };
+
+
+    // BigIntOperand<T>::type is the type used to hold an operand of type T in an expression.
+    // It is only defined for types that can be operands.
+    //
+    template<class T, class Enable = void>
+    struct BigIntOperand { };
+
+    template<>
+    struct BigIntOperand<BigInt> {
+        typedef BigIntReference type;
+        static const bool is_big = true;
+    };
+
+    template<class Operation, class Left, class Right>
+    struct BigIntOperand<BigIntExpression<Operation, Left, Right>> {
+        typedef BigIntExpression<Operation, Left, Right> type;
+        static const bool is_big = true;
+    };
+
+    template<class T>
+    struct BigIntOperand<T, typename std::enable_if<std::is_integral<T>::value>::type> {
+        typedef BigIntConstant type;
+        static const bool is_big = false;
+    };
+
+    // The type of the expression left Operation right. It only exists if at least one of the
+    // operands is a BigInt or an expression, so that these operators don't affect other types.
+    //
+    template<class Operation, class Left, class Right>
+    using BigIntResult = typename std::enable_if<
+        BigIntOperand<Left>::is_big || BigIntOperand<Right>::is_big,
+        BigIntExpression<Operation,
+            typename BigIntOperand<Left>::type, typename BigIntOperand<Right>::type> >::type;
+
+
+    template<class Left, class Right>
+    inline BigIntResult<BigIntAdd, Left, Right> operator+( const Left &left, const Right &right )
+        { return { left, right }; }
+
+    template<class Left, class Right>
+    inline BigIntResult<BigIntSubtract, Left, Right> operator-( const Left &left, const Right &right )
+        { return { left, right }; }
+
+    template<class Left, class Right>
+    inline BigIntResult<BigIntMultiply, Left, Right> operator*( const Left &left, const Right &right )
+        { return { left, right }; }
+
+
+    template<class Operation, class Left, class Right>
+    BigInt::BigInt( const BigIntExpression<Operation, Left, Right> &expression ) : BigInt( )
+    {
+        BigInt scratch;
+        expression.evaluate( *this, scratch );
+    }
+
+
+    //
+    // BigInt &BigInt::operator=( const BigIntExpression & )
+    //
+    // The expression can be evaluated in place unless it refers to this object anywhere except
+    // as its leftmost operand (as in x = x*y + z). Otherwise this object would be overwritten
+    // while the expression still needs its old value, so the expression is evaluated into a
+    // new BigInt instead.
+    //
+    template<class Operation, class Left, class Right>
+    BigInt &BigInt::operator=( const BigIntExpression<Operation, Left, Right> &expression )
+    {
+        std::size_t count = expression.references( this );
+        if( count == 0 || ( count == 1 && expression.leftmost( ) == this ) ) {
+            BigInt scratch;
+            expression.evaluate( *this, scratch );
+        }
+        else {
+            *this = BigInt( expression );
+        }
+        return *this;
+    }
+
+
+    // Division isn't done with expressions because there is nothing to be gained by it.
+    //
     inline BigInt operator/( const BigInt &left, const BigInt &right )
         { BigInt temp( left ); temp /= right; return temp; }
 
@@ -95,4 +628,14 @@ namespace vtsu {
 
 } // End of namespace vtsu
 
+namespace std {
+
+    // This allows BigInt to be used as the key of unordered containers.
+    template<>
+    struct hash<vtsu::BigInt> {
+        std::size_t operator( )( const vtsu::BigInt &value ) const { return value.hash( ); }
+    };
+
+}
+
 #endif
@@ -0,0 +1,818 @@
+/**************************************************************************
+FILE          : BigIntBench.cpp
+PROGRAMMER    : Peter Chapin
+
+(C) Copyright 2006 by Peter C. Chapin
+
+This file contains a benchmark program for the BigInt class. It reports how long various
+operations take and, where it matters, how many heap allocations each one performs. The
+allocation counts are obtained by replacing the global operator new and operator delete for the
+entire program, so this file should not be linked into anything else.
+
+The measurements are grouped into suites which can be run separately. The results can be
+printed as a table for people to read or as CSV or JSON for programs to read. Every result is
+one record with the same fields: the suite, the operation, the variant of the operation (for
+example, the algorithm used), the operand size in limbs (a limb is 32 bits), the value, its unit,
+and the number of allocations per operation (or -1 if not measured). Run the program with
+--help for the options.
+
+The "core" suite times the basic operations at sizes from one limb up to --max-limbs, which is
+a million by default. Such a run takes many minutes; use a smaller maximum for a quick check.
+The "crossover" suite compares the algorithms at each of the thresholds in BigIntTuning. Each
+variant uses the named algorithm at the top level only. A threshold is well chosen if it is near
+the size where a variant starts beating the one before it. The "decimal" suite converts a
+number with a million digits to text and back.
+**************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "BigInt.hpp"
+
+// Number of calls to the global operator new since the program started. The worker threads of
+// the parallel suite allocate too, so the count is atomic. Only the total matters, so relaxed
+// ordering is enough.
+static std::atomic<unsigned long> allocation_count( 0 );
+
+void *operator new( std::size_t size )
+{
+    allocation_count.fetch_add( 1, std::memory_order_relaxed );
+    if( void *p = std::malloc( size ? size : 1 ) ) return p;
+    throw std::bad_alloc( );
+}
+
+void operator delete( void *p ) noexcept
+{
+    std::free( p );
+}
+
+void operator delete( void *p, std::size_t ) noexcept
+{
+    std::free( p );
+}
+
+namespace {
+
+    using vtsu::BigInt;
+    using vtsu::BigIntTuning;
+
+    const std::size_t never = static_cast<std::size_t>( -1 );
+
+    // Prevents the compiler from optimizing away a computation whose result is not otherwise
+    // used. The result is stored through a volatile pointer.
+    //
+    const BigInt *volatile sink;
+
+    void keep( const BigInt &value )
+    {
+        sink = &value;
+    }
+
+
+    //
+    // Reporter
+    //
+    // Prints result records in the requested format. In text format each suite gets a heading
+    // and each record is one line under it.
+    //
+    class Reporter {
+    public:
+        enum class Format { text, csv, json };
+
+        explicit Reporter( Format format ) : format( format ), first_record( true ) { }
+
+        void start( );
+        void finish( );
+        void record( const std::string &suite, const std::string &operation,
+                     const std::string &variant, std::size_t limbs, double value,
+                     const std::string &unit, double allocations = -1.0 );
+
+    private:
+        Format      format;
+        bool        first_record;
+        std::string last_suite;  // Text format only.
+
+        static std::string json_string( const std::string &text );
+    };
+
+
+    void Reporter::start( )
+    {
+        if( format == Format::csv ) {
+            std::cout << "suite,operation,variant,limbs,value,unit,allocations\n";
+        }
+        else if( format == Format::json ) {
+            std::cout << "[\n";
+        }
+    }
+
+
+    void Reporter::finish( )
+    {
+        if( format == Format::json ) std::cout << "\n]\n";
+        std::cout << std::flush;
+    }
+
+
+    void Reporter::record( const std::string &suite, const std::string &operation,
+                           const std::string &variant, std::size_t limbs, double value,
+                           const std::string &unit, double allocations )
+    {
+        switch( format ) {
+        case Format::text:
+            if( suite != last_suite ) {
+                std::cout << "--- " << suite << " ---\n";
+                last_suite = suite;
+            }
+            std::cout << "  " << std::left << std::setw( 28 ) << operation + " " + variant
+                      << std::right << std::setw( 9 ) << limbs << " limbs  "
+                      << std::setw( 12 ) << value << " " << unit;
+            if( allocations >= 0.0 ) std::cout << "  " << allocations << " allocations/op";
+            std::cout << "\n";
+            break;
+
+        case Format::csv:
+            std::cout << suite << "," << operation << "," << variant << "," << limbs << ","
+                      << value << "," << unit << "," << allocations << "\n";
+            break;
+
+        case Format::json:
+            std::cout << ( first_record ? "  " : ",\n  " )
+                      << "{\"suite\": " << json_string( suite )
+                      << ", \"operation\": " << json_string( operation )
+                      << ", \"variant\": " << json_string( variant )
+                      << ", \"limbs\": " << limbs
+                      << ", \"value\": " << value
+                      << ", \"unit\": " << json_string( unit )
+                      << ", \"allocations\": " << allocations << "}";
+            break;
+        }
+        first_record = false;
+    }
+
+
+    // Returns the text as a JSON string literal. The names used here never contain characters
+    // that need escaping other than quotes and backslashes.
+    //
+    std::string Reporter::json_string( const std::string &text )
+    {
+        std::string result = "\"";
+        for( char ch : text ) {
+            if( ch == '"' || ch == '\\' ) result += '\\';
+            result += ch;
+        }
+        return result + "\"";
+    }
+
+
+    // The command line options.
+    struct Options {
+        Reporter::Format         format      = Reporter::Format::text;
+        std::size_t              max_limbs   = 1000000;
+        double                   min_time    = 20.0;  // Milliseconds per measurement.
+        std::vector<std::string> suites;              // Empty means all of them.
+        bool                     help        = false;
+    };
+
+    Options   options;
+    Reporter *reporter;
+
+
+    // The result of timing an operation.
+    struct Timing {
+        double nanoseconds;  // Per operation.
+        double allocations;  // Per operation.
+    };
+
+    //
+    // time_operation
+    //
+    // Runs the operation repeatedly until at least options.min_time milliseconds have passed
+    // and returns the average time and number of allocations. Slow operations are run once.
+    //
+    template< typename Operation >
+    Timing time_operation( Operation operation )
+    {
+        unsigned long allocations_before = allocation_count.load( std::memory_order_relaxed );
+        long iterations = 0;
+        auto start = std::chrono::steady_clock::now( );
+        std::chrono::duration<double, std::milli> elapsed;
+        do {
+            // Do a batch of operations between clock readings so that very fast operations
+            // are not swamped by the cost of reading the clock.
+            long batch = std::max( 1L, iterations );
+            for( long i = 0; i < batch; ++i ) operation( );
+            iterations += batch;
+            elapsed = std::chrono::steady_clock::now( ) - start;
+        } while( elapsed.count( ) < options.min_time );
+
+        Timing result;
+        result.nanoseconds = elapsed.count( ) * 1.0e6 / iterations;
+        result.allocations =
+            static_cast<double>(
+                allocation_count.load( std::memory_order_relaxed ) - allocations_before ) / iterations;
+        return result;
+    }
+
+    // Times the operation and reports the result in the given unit ("ns", "us", or "ms").
+    template< typename Operation >
+    void measure( const std::string &suite, const std::string &operation_name,
+                  const std::string &variant, std::size_t limbs, const std::string &unit,
+                  Operation operation )
+    {
+        Timing timing = time_operation( operation );
+        double scale = ( unit == "ms" ) ? 1.0e-6 : ( unit == "us" ) ? 1.0e-3 : 1.0;
+        reporter->record( suite, operation_name, variant, limbs,
+                          timing.nanoseconds * scale, unit, timing.allocations );
+    }
+
+    // Returns the time in milliseconds taken by one run of the operation. For operations too
+    // slow to repeat many times.
+    //
+    template< typename Operation >
+    double time_once( Operation operation )
+    {
+        auto start = std::chrono::steady_clock::now( );
+        operation( );
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now( ) - start ).count( );
+    }
+
+    // Returns the sizes to use for a sweep from first to last limbs: powers of four, plus
+    // last itself.
+    //
+    std::vector<std::size_t> sweep( std::size_t first, std::size_t last )
+    {
+        std::vector<std::size_t> sizes;
+        for( std::size_t size = first; size <= last && size != 0; size *= 4 ) sizes.push_back( size );
+        if( sizes.empty( ) || sizes.back( ) != last ) {
+            if( last >= first ) sizes.push_back( last );
+        }
+        return sizes;
+    }
+
+    // Returns a pseudo-random BigInt with exactly the given number of limbs. Large values are
+    // built by divide and conquer so that even huge operands can be created quickly.
+    //
+    BigInt make_value( std::size_t limb_count )
+    {
+        static unsigned long seed = 12345;
+
+        if( limb_count == 1 ) {
+            // Make sure the top bit is set so that the limb count is exact.
+            seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+            BigInt high( static_cast<long>( ( seed >> 48 ) | 0x8000 ) );
+            high *= BigInt( 65536 );
+            high += BigInt( static_cast<long>( ( seed >> 16 ) & 0xFFFF ) );
+            return high;
+        }
+
+        std::size_t low_count = limb_count / 2;
+        BigInt shift( 1 );
+        BigInt factor( 65536 );
+        factor *= factor;
+        for( std::size_t exponent = low_count; exponent != 0; exponent /= 2 ) {
+            if( exponent & 1 ) shift *= factor;
+            factor *= factor;
+        }
+
+        // The low half may have leading zero bits but its top limb is always non-zero.
+        return make_value( limb_count - low_count ) * shift + make_value( low_count );
+    }
+
+
+    //-----------------------------------
+    //           The suites
+    //-----------------------------------
+
+    // Reports the tuning parameters so that results from different runs can be compared
+    // knowing what settings were in effect.
+    //
+    void tuning( )
+    {
+        const char *unit = "limbs";
+        reporter->record( "tuning", "karatsuba_threshold", "", 0,
+                          static_cast<double>( BigIntTuning::karatsuba_threshold ), unit );
+        reporter->record( "tuning", "toom3_threshold", "", 0,
+                          static_cast<double>( BigIntTuning::toom3_threshold ), unit );
+        reporter->record( "tuning", "ntt_threshold", "", 0,
+                          static_cast<double>( BigIntTuning::ntt_threshold ), unit );
+        reporter->record( "tuning", "burnikel_ziegler_threshold", "", 0,
+                          static_cast<double>( BigIntTuning::burnikel_ziegler_threshold ), unit );
+        reporter->record( "tuning", "radix_threshold", "", 0,
+                          static_cast<double>( BigIntTuning::radix_threshold ), unit );
+        reporter->record( "tuning", "montgomery_threshold", "", 0,
+                          static_cast<double>( BigIntTuning::montgomery_threshold ), unit );
+        reporter->record( "tuning", "parallel_threshold", "", 0,
+                          static_cast<double>( BigIntTuning::parallel_threshold ), unit );
+        reporter->record( "tuning", "thread_count", "", 0,
+                          static_cast<double>( BigIntTuning::thread_count ), "threads" );
+    }
+
+
+    // Copying, moving, and arithmetic on small values, which are stored without allocating.
+    void small( )
+    {
+        for( std::size_t limb_count : { 1, 2, 4, 8 } ) {
+            BigInt a = make_value( limb_count );
+            BigInt b = make_value( limb_count );
+
+            measure( "small", "copy", "", limb_count, "ns", [&]( ) {
+                BigInt temp( a ); keep( temp );
+            } );
+            measure( "small", "move", "", limb_count, "ns", [&]( ) {
+                BigInt temp( a ); BigInt moved( std::move( temp ) ); keep( moved );
+            } );
+            measure( "small", "add", "", limb_count, "ns", [&]( ) {
+                BigInt temp = a + b; keep( temp );
+            } );
+            measure( "small", "subtract", "", limb_count, "ns", [&]( ) {
+                BigInt temp = a - b; keep( temp );
+            } );
+            measure( "small", "multiply", "", limb_count, "ns", [&]( ) {
+                BigInt temp = a * b; keep( temp );
+            } );
+        }
+    }
+
+
+    //
+    // core
+    //
+    // The basic operations with n limb operands for a sweep of sizes. Division divides a 2n
+    // limb number by an n limb number. Modular exponentiation raises an n limb number to a 64
+    // bit power modulo an n limb odd number, including the setup of the modulus. Comparison
+    // compares equal values, which is the slowest case. Conversion to and from text is of an n
+    // limb number; the first decimal conversion fills the cache of powers of ten, so it is done
+    // before the timing starts.
+    //
+    void core( )
+    {
+        for( std::size_t n : sweep( 1, options.max_limbs ) ) {
+            BigInt a = make_value( n ), b = make_value( n ), result;
+            const char *unit = "ns";  // The same for every size so the results can be plotted.
+
+            measure( "core", "add", "", n, unit, [&]( ) { result = a + b; keep( result ); } );
+            measure( "core", "subtract", "", n, unit, [&]( ) { result = a - b; keep( result ); } );
+            measure( "core", "multiply", "", n, unit, [&]( ) { result = a * b; keep( result ); } );
+            {
+                BigInt dividend = make_value( 2 * n );
+                measure( "core", "divmod", "", n, unit, [&]( ) {
+                    std::pair<BigInt, BigInt> qr = vtsu::divmod( dividend, b ); keep( qr.first );
+                } );
+            }
+            {
+                BigInt modulus = b;
+                if( modulus % 2 == 0 ) modulus += 1;
+                BigInt exponent = make_value( 2 );
+                measure( "core", "pow_mod", "", n, unit, [&]( ) {
+                    result = vtsu::pow_mod( a, exponent, modulus ); keep( result );
+                } );
+            }
+            {
+                BigInt copy = a;
+                volatile int order = 0;
+                measure( "core", "compare", "", n, unit, [&]( ) { order = vtsu::compare( a, copy ); } );
+                (void)order;
+            }
+            {
+                std::string text = a.to_string( );
+                measure( "core", "to_decimal", "", n, unit, [&]( ) { text = a.to_string( ); } );
+                measure( "core", "from_decimal", "", n, unit, [&]( ) {
+                    result = BigInt::from_string( text ); keep( result );
+                } );
+                text = a.to_string( 16 );
+                measure( "core", "to_hex", "", n, unit, [&]( ) { text = a.to_string( 16 ); } );
+                measure( "core", "from_hex", "", n, unit, [&]( ) {
+                    result = BigInt::from_string( text, 16 ); keep( result );
+                } );
+            }
+        }
+    }
+
+
+    // Measures the speed of the in place addition and subtraction kernels on long operands.
+    // The values alternate between two fixed points so every iteration does the same work.
+    // The second variant subtracts a larger value, so the result changes sign.
+    //
+    void throughput( )
+    {
+        for( std::size_t limb_count : sweep( 64, std::min<std::size_t>( options.max_limbs, 65536 ) ) ) {
+            BigInt a = make_value( limb_count );
+            BigInt b = make_value( limb_count - 1 );
+
+            Timing add = time_operation( [&]( ) { a += b; a -= b; } );
+            keep( a );
+            Timing subtract = time_operation( [&]( ) { b -= a; b += a; } );
+            keep( b );
+
+            double per_limb = 1.0 / ( 2.0 * limb_count );
+            reporter->record( "throughput", "add_subtract", "same_sign", limb_count,
+                              add.nanoseconds * per_limb, "ns/limb" );
+            reporter->record( "throughput", "add_subtract", "sign_change", limb_count,
+                              subtract.nanoseconds * per_limb, "ns/limb" );
+        }
+    }
+
+
+    //
+    // crossover
+    //
+    // Compares the algorithms for multiplication, division, modular reduction, and decimal
+    // conversion near their thresholds. Every threshold is restored afterward.
+    //
+    void crossover( )
+    {
+        const std::size_t karatsuba_default  = BigIntTuning::karatsuba_threshold;
+        const std::size_t toom3_default      = BigIntTuning::toom3_threshold;
+        const std::size_t ntt_default        = BigIntTuning::ntt_threshold;
+        const std::size_t bz_default         = BigIntTuning::burnikel_ziegler_threshold;
+        const std::size_t montgomery_default = BigIntTuning::montgomery_threshold;
+        const std::size_t radix_default      = BigIntTuning::radix_threshold;
+        const std::size_t largest = options.max_limbs;
+
+        for( std::size_t n = 8; n <= std::min<std::size_t>( largest, 8192 ); n *= 2 ) {
+            BigInt a = make_value( n ), b = make_value( n );
+            auto product = [&]( ) { BigInt p = a * b; keep( p ); };
+
+            BigIntTuning::karatsuba_threshold = never;
+            BigIntTuning::toom3_threshold     = never;
+            BigIntTuning::ntt_threshold       = never;
+            measure( "crossover", "multiply", "schoolbook", n, "us", product );
+            BigIntTuning::karatsuba_threshold = std::min( karatsuba_default, n );
+            measure( "crossover", "multiply", "karatsuba", n, "us", product );
+            BigIntTuning::toom3_threshold = std::min( toom3_default, n );
+            measure( "crossover", "multiply", "toom3", n, "us", product );
+
+            BigIntTuning::karatsuba_threshold = karatsuba_default;
+            BigIntTuning::toom3_threshold     = toom3_default;
+            BigIntTuning::ntt_threshold       = ntt_default;
+        }
+
+        for( std::size_t n = 256; n <= std::min<std::size_t>( largest, 65536 ); n *= 2 ) {
+            BigInt a = make_value( n ), b = make_value( n );
+            auto product = [&]( ) { BigInt p = a * b; keep( p ); };
+
+            BigIntTuning::ntt_threshold = never;
+            measure( "crossover", "multiply_large", "toom3", n, "us", product );
+            BigIntTuning::ntt_threshold = n;
+            measure( "crossover", "multiply_large", "ntt", n, "us", product );
+            BigIntTuning::ntt_threshold = ntt_default;
+        }
+
+        for( std::size_t n = 16; n <= std::min<std::size_t>( largest, 8192 ); n *= 2 ) {
+            BigInt a = make_value( 2 * n ), b = make_value( n );
+            auto quotient = [&]( ) { std::pair<BigInt, BigInt> qr = vtsu::divmod( a, b ); keep( qr.first ); };
+
+            BigIntTuning::burnikel_ziegler_threshold = never;
+            measure( "crossover", "divmod", "knuth", n, "us", quotient );
+            BigIntTuning::burnikel_ziegler_threshold = std::min( bz_default, n );
+            measure( "crossover", "divmod", "burnikel_ziegler", n, "us", quotient );
+            BigIntTuning::burnikel_ziegler_threshold = bz_default;
+        }
+
+        // Raising to a 256 bit power. The first variant multiplies and then divides at every
+        // step, as one would do without BigIntModulus. Even moduli use Barrett reduction.
+        //
+        for( std::size_t n = 4; n <= std::min<std::size_t>( largest, 1024 ); n *= 2 ) {
+            BigInt odd = make_value( n );
+            if( odd % 2 == 0 ) odd += 1;
+            BigInt even = odd + 1;
+            BigInt base = make_value( n ) % odd;
+            BigInt exponent = make_value( 8 );
+            std::string bits = exponent.to_string( 2 );
+
+            measure( "crossover", "pow_mod", "divide", n, "ms", [&]( ) {
+                BigInt result( 1 );
+                for( char bit : bits ) {
+                    result *= result; result %= odd;
+                    if( bit == '1' ) { result *= base; result %= odd; }
+                }
+                keep( result );
+            } );
+            BigIntTuning::montgomery_threshold = never;
+            vtsu::BigIntModulus word( odd );
+            measure( "crossover", "pow_mod", "montgomery_word", n, "ms", [&]( ) {
+                BigInt result = word.pow( base, exponent ); keep( result );
+            } );
+            BigIntTuning::montgomery_threshold = 1;
+            vtsu::BigIntModulus multiply( odd );
+            measure( "crossover", "pow_mod", "montgomery_multiply", n, "ms", [&]( ) {
+                BigInt result = multiply.pow( base, exponent ); keep( result );
+            } );
+            BigIntTuning::montgomery_threshold = montgomery_default;
+            vtsu::BigIntModulus barrett( even );
+            measure( "crossover", "pow_mod", "barrett", n, "ms", [&]( ) {
+                BigInt result = barrett.pow( base, exponent ); keep( result );
+            } );
+        }
+
+        // The quadratic variant converts nine digits at a time with one pass over the number
+        // per chunk. The other splits the number with a power of ten first.
+        //
+        for( std::size_t n = 8; n <= std::min<std::size_t>( largest, 512 ); n *= 2 ) {
+            BigInt a = make_value( n ), result;
+            std::string text = a.to_string( );
+
+            BigIntTuning::radix_threshold = never;
+            measure( "crossover", "to_decimal", "quadratic", n, "us",
+                     [&]( ) { text = a.to_string( ); } );
+            measure( "crossover", "from_decimal", "quadratic", n, "us", [&]( ) {
+                result = BigInt::from_string( text ); keep( result );
+            } );
+            BigIntTuning::radix_threshold = std::min( radix_default, n );
+            measure( "crossover", "to_decimal", "divide_and_conquer", n, "us",
+                     [&]( ) { text = a.to_string( ); } );
+            measure( "crossover", "from_decimal", "divide_and_conquer", n, "us", [&]( ) {
+                result = BigInt::from_string( text ); keep( result );
+            } );
+            BigIntTuning::radix_threshold = radix_default;
+        }
+    }
+
+
+    //
+    // decimal
+    //
+    // Converts a number with a million decimal digits from text, and then back to text twice in
+    // a new thread. The first conversion to text also computes the powers of ten and their
+    // reciprocals, which each thread caches. The second finds them already computed.
+    //
+    void decimal( )
+    {
+        const std::size_t digits = 1000000;
+        std::string text( digits, '0' );
+        unsigned long seed = 12345;
+        for( char &digit : text ) {
+            seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+            digit = static_cast<char>( '0' + ( seed >> 33 ) % 10 );
+        }
+        text[0] = '7';
+
+        BigInt value;
+        const double parse = time_once( [&]( ) { value = BigInt::from_string( text ); } );
+        const std::size_t limbs = ( value.to_string( 16 ).size( ) + 7 ) / 8;
+        reporter->record( "decimal", "from_decimal", "", limbs, parse, "ms" );
+
+        std::string printed;
+        double first = 0.0, cached = 0.0;
+        std::thread fresh( [&]( ) {
+            first  = time_once( [&]( ) { printed = value.to_string( ); } );
+            cached = time_once( [&]( ) { printed = value.to_string( ); } );
+        } );
+        fresh.join( );
+        reporter->record( "decimal", "to_decimal", "first_in_thread", limbs, first, "ms" );
+        reporter->record( "decimal", "to_decimal", "cached", limbs, cached, "ms" );
+        if( printed != text ) std::cerr << "decimal: the text read back differs\n";
+    }
+
+
+    // Compares evaluating x = a*b + c*d - e and a step of Horner's rule, x = x*a + c, using
+    // expressions with doing the same thing with a temporary for every operator (as the
+    // operators did before expressions were introduced).
+    //
+    void expressions( )
+    {
+        for( std::size_t n : { 2, 8, 64 } ) {
+            BigInt a = make_value( n ), b = make_value( n );
+            BigInt c = make_value( n ), d = make_value( n );
+            BigInt e = make_value( n );
+            BigInt x;
+
+            measure( "expressions", "sum_of_products", "temporaries", n, "ns", [&]( ) {
+                BigInt product1( a ); product1 *= b;
+                BigInt product2( c ); product2 *= d;
+                BigInt sum( product1 ); sum += product2;
+                BigInt difference( sum ); difference -= e;
+                x = std::move( difference ); keep( x );
+            } );
+            measure( "expressions", "sum_of_products", "expression", n, "ns", [&]( ) {
+                x = a*b + c*d - e; keep( x );
+            } );
+            measure( "expressions", "horner_step", "temporaries", n, "ns", [&]( ) {
+                x = b;
+                BigInt product( x ); product *= a;
+                BigInt sum( product ); sum += c;
+                x = std::move( sum ); keep( x );
+            } );
+            measure( "expressions", "horner_step", "expression", n, "ns", [&]( ) {
+                x = b;
+                x = x*a + c; keep( x );
+            } );
+        }
+    }
+
+
+    // Measures a batch computation that creates many short lived temporaries: the sum of
+    // (a[i]*b[i] + c[i]*d[i] - e[i])^2 for 1000 groups of 8 limb operands. It is done using
+    // ordinary memory, using a pool, and inside an arena.
+    //
+    void memory( )
+    {
+        const std::size_t group_count = 1000;
+        std::vector<BigInt> values;
+        for( std::size_t i = 0; i < 5 * group_count; ++i ) values.push_back( make_value( 8 ) );
+
+        auto batch = [&]( ) {
+            BigInt total;
+            for( std::size_t i = 0; i < 5 * group_count; i += 5 ) {
+                BigInt term = values[i]*values[i + 1] + values[i + 2]*values[i + 3] - values[i + 4];
+                BigInt squared = term * term;
+                total += squared;
+            }
+            return total;
+        };
+
+        measure( "memory", "batch", "operator_new", 8, "us", [&]( ) {
+            BigInt total = batch( ); keep( total );
+        } );
+        measure( "memory", "batch", "pool", 8, "us", [&]( ) {
+            std::pmr::unsynchronized_pool_resource pool;
+            std::pmr::memory_resource *previous = BigInt::set_memory_resource( &pool );
+            { BigInt total = batch( ); keep( total ); }
+            BigInt::set_memory_resource( previous );
+        } );
+        measure( "memory", "batch", "arena", 8, "us", [&]( ) {
+            vtsu::BigIntArena arena;
+            BigInt total = arena.keep( batch( ) ); keep( total );
+        } );
+    }
+
+
+    // Compares large multiplications and factorials done by one thread with the same work
+    // spread over one thread per core. The factorials are reported with their argument in
+    // place of a size.
+    //
+    void parallel( )
+    {
+        const unsigned default_threads = BigIntTuning::thread_count;
+        const unsigned cores = std::max( 1U, std::thread::hardware_concurrency( ) );
+        const std::string all_cores = "threads_" + std::to_string( cores );
+
+        for( std::size_t n : sweep( 4096, std::min<std::size_t>( options.max_limbs, 262144 ) ) ) {
+            BigInt a = make_value( n ), b = make_value( n );
+            for( int i = 0; i < 2; ++i ) {
+                BigIntTuning::thread_count = ( i == 0 ) ? 1 : cores;
+                measure( "parallel", "multiply", ( i == 0 ) ? "threads_1" : all_cores, n, "ms",
+                         [&]( ) { BigInt p = a * b; keep( p ); } );
+            }
+        }
+        for( unsigned long n : { 100000UL, 300000UL } ) {
+            for( int i = 0; i < 2; ++i ) {
+                BigIntTuning::thread_count = ( i == 0 ) ? 1 : cores;
+                measure( "parallel", "factorial", ( i == 0 ) ? "threads_1" : all_cores, n, "ms",
+                         [&]( ) { BigInt f = vtsu::factorial( n ); keep( f ); } );
+            }
+        }
+        BigIntTuning::thread_count = default_threads;
+    }
+
+
+    // Sorts and removes duplicates from a million values, then does the same with a hash
+    // table. The values have a mix of signs and lengths, and many share their leading limbs,
+    // so that the comparisons have to look past the first limb.
+    //
+    void sort( )
+    {
+        const std::size_t count = 1000000;
+        std::vector<BigInt> values;
+        values.reserve( count );
+        BigInt prefix = make_value( 3 );
+        for( std::size_t i = 0; i < count; ++i ) {
+            BigInt value = make_value( 1 + i % 4 );
+            if( i % 3 == 0 ) value = prefix * 65536 * 65536 + static_cast<long>( i % 50000 );
+            if( i % 5 == 0 ) value = 0 - value;
+            values.push_back( value );
+        }
+
+        std::vector<BigInt> sorted( values );
+        reporter->record( "sort", "sort", "std_sort", 4,
+            time_once( [&]( ) { std::sort( sorted.begin( ), sorted.end( ) ); } ), "ms" );
+        reporter->record( "sort", "deduplicate", "std_unique", 4, time_once( [&]( ) {
+            sorted.erase( std::unique( sorted.begin( ), sorted.end( ) ), sorted.end( ) );
+        } ), "ms" );
+        std::unordered_set<BigInt> set;
+        reporter->record( "sort", "deduplicate", "unordered_set", 4, time_once( [&]( ) {
+            set.insert( values.begin( ), values.end( ) );
+        } ), "ms" );
+    }
+
+
+    struct Suite {
+        const char *name;
+        void ( *function )( );
+        const char *description;
+    };
+
+    const Suite suites[] = {
+        { "tuning",      tuning,      "the tuning parameters in effect" },
+        { "small",       small,       "copies and arithmetic on values of 1 to 8 limbs" },
+        { "core",        core,        "all basic operations from 1 limb to --max-limbs" },
+        { "throughput",  throughput,  "addition and subtraction speed per limb" },
+        { "crossover",   crossover,   "algorithm comparisons at each tuning threshold" },
+        { "decimal",     decimal,     "converting a million digit number to and from text" },
+        { "expressions", expressions, "expression templates compared with temporaries" },
+        { "memory",      memory,      "operator new, a pool, and an arena" },
+        { "parallel",    parallel,    "one thread compared with one thread per core" },
+        { "sort",        sort,        "sorting and deduplicating a million values" },
+    };
+
+
+    // Writes the usage message to output: std::cout when it was asked for and std::cerr when
+    // the command line was wrong.
+    //
+    void usage( std::ostream &output )
+    {
+        output <<
+            "Usage: bigint_bench [options]\n"
+            "  --format=text|csv|json  Output format (default text)\n"
+            "  --help                  Print this message and exit\n"
+            "  --max-limbs=N           Largest operand size for the core suite (default 1000000)\n"
+            "  --min-time=MS           Minimum time spent on each measurement (default 20)\n"
+            "  --suite=NAME[,NAME...]  Suites to run (default all):\n";
+        for( const Suite &suite : suites ) {
+            output << "      " << std::left << std::setw( 12 ) << suite.name
+                   << suite.description << "\n";
+        }
+    }
+
+
+    // Parses the command line into options. Returns false if it isn't valid.
+    bool parse_options( int argc, char **argv )
+    {
+        for( int i = 1; i < argc; ++i ) {
+            std::string argument = argv[i];
+            std::string::size_type equals = argument.find( '=' );
+            std::string name  = argument.substr( 0, equals );
+            std::string value = ( equals == std::string::npos ) ? "" : argument.substr( equals + 1 );
+
+            if( name == "--help" && equals == std::string::npos ) {
+                options.help = true;
+            }
+            else if( name == "--format" ) {
+                if( value == "text" ) options.format = Reporter::Format::text;
+                else if( value == "csv" ) options.format = Reporter::Format::csv;
+                else if( value == "json" ) options.format = Reporter::Format::json;
+                else return false;
+            }
+            else if( name == "--max-limbs" ) {
+                options.max_limbs = std::strtoul( value.c_str( ), nullptr, 10 );
+                if( options.max_limbs == 0 ) return false;
+            }
+            else if( name == "--min-time" ) {
+                options.min_time = std::strtod( value.c_str( ), nullptr );
+            }
+            else if( name == "--suite" ) {
+                std::istringstream list( value );
+                std::string suite_name;
+                while( std::getline( list, suite_name, ',' ) ) {
+                    bool known = false;
+                    for( const Suite &suite : suites ) known = known || suite_name == suite.name;
+                    if( !known ) return false;
+                    options.suites.push_back( suite_name );
+                }
+            }
+            else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+}
+
+int main( int argc, char **argv )
+{
+    if( !parse_options( argc, argv ) ) {
+        usage( std::cerr );
+        return EXIT_FAILURE;
+    }
+    if( options.help ) {
+        usage( std::cout );
+        return EXIT_SUCCESS;
+    }
+
+    Reporter output( options.format );
+    reporter = &output;
+    output.start( );
+    for( const Suite &suite : suites ) {
+        if( options.suites.empty( ) ||
+            std::find( options.suites.begin( ), options.suites.end( ), suite.name ) !=
+                options.suites.end( ) ) {
+            suite.function( );
+        }
+    }
+    output.finish( );
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,489 @@
+/**************************************************************************
+FILE          : BigIntDivide.cpp
+PROGRAMMER    : Peter Chapin
+
+(C) Copyright 2006 by Peter C. Chapin
+
+This file contains the division engine used by BigInt. Three algorithms are provided:
+
++ Short division by a single limb. This is just the grade school method with a one "digit"
+  divisor. It takes O(n) time.
+
++ Knuth's Algorithm D (The Art of Computer Programming, Volume 2, section 4.3.1). This is long
+  division done carefully: each quotient limb is estimated from the leading limbs and then
+  corrected. It takes O(n*m) time for an n limb dividend and an m limb divisor.
+
++ Burnikel and Ziegler's recursive division ("Fast Recursive Division," 1998). The problem is
+  split into halves in such a way that most of the work becomes multiplication, so it benefits
+  from the fast multiplication algorithms in BigIntMultiply.cpp. It takes about 2 M(n) log n
+  time, where M(n) is the time to multiply two n limb numbers.
+
+Every algorithm produces the quotient and the remainder at the same time.
+
+Division by the same large divisor many times is done with Barrett reduction instead, which
+replaces each division with two multiplications using a precomputed reciprocal of the divisor.
+The reciprocal of a large divisor is computed with Newton's iteration, which takes about as long
+as a few multiplications.
+**************************************************************************/
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "BigIntKernels.hpp"
+
+namespace vtsu {
+
+    // In the divmod part of BigIntBench's crossover suite (a 2n-limb dividend, an n-limb divisor,
+    // -O2, x86-64), Knuth's algorithm was still faster at n = 512 (about 530 us against 615 us)
+    // and the two were within the noise of each other at 640 and 768. Burnikel-Ziegler won from
+    // 1024 (about 1200 us against 1410 us) and by a wide margin at 2048 (3180 us against 5120 us).
+    std::size_t BigIntTuning::burnikel_ziegler_threshold = 1024;
+
+    namespace kernels {
+        namespace {
+
+            typedef std::vector<limb_type> LimbVector;
+
+            // The recursion in Burnikel-Ziegler division stops at divisors of about this size.
+            // It is smaller than the threshold for using the algorithm at all because the
+            // recursion only pays off when there are several levels of it.
+            //
+            std::size_t base_case_size( )
+            {
+                return std::max<std::size_t>( BigIntTuning::burnikel_ziegler_threshold / 4, 2 );
+            }
+
+            // Reciprocals of divisors with fewer limbs than this are computed by division and
+            // larger ones by Newton's iteration. The iteration is all multiplication, so it only
+            // pays off well above the Karatsuba threshold. With the default of 32 this is 128;
+            // Newton's iteration was about even with division from there to 256 limbs (-O2,
+            // x86-64) and faster beyond: 0.22 ms against 0.34 ms at 512 limbs, 5.1 ms against
+            // 9.7 ms at 4096, and 72 ms against 162 ms at 52000. Making it 256 changed nothing
+            // measurable. It is never less than four, which approximate_reciprocal needs.
+            //
+            std::size_t newton_threshold( )
+            {
+                const std::size_t karatsuba = BigIntTuning::karatsuba_threshold;
+                if( karatsuba > std::numeric_limits<std::size_t>::max( ) / 4 ) return karatsuba;
+                return std::max<std::size_t>( 4 * karatsuba, 4 );
+            }
+
+            //
+            // divide_knuth
+            //
+            // Algorithm D. Here bn >= 2. The divisor is first shifted so that its top bit is set.
+            // That guarantees the estimate of each quotient limb made from the top two limbs of
+            // the current remainder is at most two too large.
+            //
+            void divide_knuth( limb_type *q, limb_type *r,
+                const limb_type *a, std::size_t an, const limb_type *b, std::size_t bn )
+            {
+                const int shift = leading_zeros( b[bn - 1] );
+                LimbVector v( bn ), u( an + 1 );
+                shift_left( v.data( ), b, bn, shift );
+                u[an] = shift_left( u.data( ), a, an, shift );
+
+                const wide_type base       = wide_type( 1 ) << limb_bits;
+                const limb_type v_top      = v[bn - 1];
+                const limb_type v_next     = v[bn - 2];
+
+                for( std::size_t j = an - bn + 1; j > 0; ) {
+                    --j;
+
+                    // Estimate the quotient limb and refine the estimate using the next limb.
+                    wide_type numerator = ( static_cast<wide_type>( u[j + bn] ) << limb_bits ) | u[j + bn - 1];
+                    wide_type q_hat = numerator / v_top;
+                    wide_type r_hat = numerator % v_top;
+                    while( q_hat >= base ||
+                           q_hat * v_next > ( ( r_hat << limb_bits ) | u[j + bn - 2] ) ) {
+                        --q_hat;
+                        r_hat += v_top;
+                        if( r_hat >= base ) break;
+                    }
+
+                    // Multiply and subtract. If the result is negative the estimate was still one
+                    // too large (this is rare) so add the divisor back.
+                    //
+                    limb_type borrow = submul_1( &u[j], v.data( ), bn, static_cast<limb_type>( q_hat ) );
+                    limb_type top = u[j + bn];
+                    u[j + bn] = top - borrow;
+                    if( top < borrow ) {
+                        --q_hat;
+                        u[j + bn] += add_n( &u[j], &u[j], v.data( ), bn );
+                    }
+                    q[j] = static_cast<limb_type>( q_hat );
+                }
+
+                shift_right( r, u.data( ), bn, shift );
+            }
+
+
+            // Divides a (2n limbs) by b (n limbs, top bit set) where a < b * B^n. The quotient
+            // and remainder each have n limbs.
+            //
+            void divide_2n_by_n( limb_type *q, limb_type *r,
+                const limb_type *a, const limb_type *b, std::size_t n );
+
+            //
+            // divide_3n_by_2n
+            //
+            // Divides a (3m limbs) by b (2m limbs, top bit set) where a < b * B^m. The quotient
+            // has m limbs and the remainder 2m limbs. Splitting b = [b1, b2] (b1 is the high
+            // half), the quotient is estimated by dividing the top of a by b1 alone and then
+            // corrected using b2. Like Algorithm D, the estimate is at most two too large.
+            //
+            void divide_3n_by_2n( limb_type *q, limb_type *r,
+                const limb_type *a, const limb_type *b, std::size_t m )
+            {
+                const limb_type *a3 = a;
+                const limb_type *a1 = a + 2 * m;
+                const limb_type *b2 = b;
+                const limb_type *b1 = b + m;
+
+                // r_hat holds [r1, a3] and has room for the carries produced below.
+                LimbVector r_hat( 2 * m + 2, 0 );
+                if( compare_n( a1, b1, m ) < 0 ) {
+                    divide_2n_by_n( q, &r_hat[m], a + m, b1, m );
+                }
+                else {
+                    // Since a < b * B^m, this can only happen if a1 == b1. Then the quotient
+                    // estimate is B^m - 1 and r1 = [a1, a2] - [b1, 0] + b1 = a2 + b1.
+                    //
+                    std::fill( q, q + m, ~limb_type( 0 ) );
+                    r_hat[2 * m] = add_n( &r_hat[m], a + m, b1, m );
+                }
+                std::copy( a3, a3 + m, r_hat.begin( ) );
+
+                LimbVector d( 2 * m + 2, 0 );
+                multiply( d.data( ), q, m, b2, m );
+
+                // While r_hat < d, the quotient is too large.
+                while( compare_n( r_hat.data( ), d.data( ), 2 * m + 2 ) < 0 ) {
+                    add( r_hat.data( ), r_hat.data( ), 2 * m + 2, b, 2 * m );
+                    sub_1( q, q, m, 1 );
+                }
+                sub_n( r_hat.data( ), r_hat.data( ), d.data( ), 2 * m + 2 );
+                std::copy( r_hat.begin( ), r_hat.begin( ) + 2 * m, r );
+            }
+
+
+            void divide_2n_by_n( limb_type *q, limb_type *r,
+                const limb_type *a, const limb_type *b, std::size_t n )
+            {
+                // Fall back to Algorithm D when the problem is small or can't be split evenly.
+                if( n % 2 != 0 || n < base_case_size( ) ) {
+                    if( n == 1 ) {
+                        // a < b * B, so the quotient fits in one limb.
+                        wide_type numerator = ( static_cast<wide_type>( a[1] ) << limb_bits ) | a[0];
+                        q[0] = static_cast<limb_type>( numerator / b[0] );
+                        r[0] = static_cast<limb_type>( numerator % b[0] );
+                        return;
+                    }
+                    LimbVector quotient( n + 1 );
+                    divide_knuth( quotient.data( ), r, a, 2 * n, b, n );
+                    std::copy( quotient.begin( ), quotient.begin( ) + n, q );
+                    return;
+                }
+
+                // a = [a1, a2, a3, a4]. First divide [a1, a2, a3] by b, then [remainder, a4].
+                const std::size_t m = n / 2;
+                LimbVector partial( 3 * m );
+                divide_3n_by_2n( q + m, &partial[m], a + m, b, m );
+                std::copy( a, a + m, partial.begin( ) );
+                divide_3n_by_2n( q, r, partial.data( ), b, m );
+            }
+
+
+            //
+            // divide_burnikel_ziegler
+            //
+            // Handles operands of any size. The divisor is padded (by shifting both operands to
+            // the left) to a size that can be halved repeatedly down to the threshold. The
+            // dividend is then processed in blocks the size of the divisor, most significant
+            // first, much like long division with very large digits.
+            //
+            void divide_burnikel_ziegler( limb_type *q, limb_type *r,
+                const limb_type *a, std::size_t an, const limb_type *b, std::size_t bn )
+            {
+                // Choose n = j * 2^k >= bn with j below the threshold.
+                std::size_t m = 1;
+                while( m * base_case_size( ) <= bn ) m *= 2;
+                const std::size_t n = ( ( bn + m - 1 ) / m ) * m;
+
+                // Shift so that the divisor has exactly n limbs with its top bit set.
+                const std::size_t limb_shift = n - bn;
+                const int bit_shift = leading_zeros( b[bn - 1] );
+                LimbVector b_shifted( n, 0 );
+                shift_left( &b_shifted[limb_shift], b, bn, bit_shift );
+
+                // The shifted dividend needs t blocks of n limbs such that its top block is less
+                // than half of B^n (and therefore less than the divisor).
+                //
+                std::size_t a_size = an + limb_shift + 1;
+                std::size_t t = std::max<std::size_t>( 2, ( a_size + n - 1 ) / n );
+                LimbVector a_shifted( t * n, 0 );
+                a_shifted[an + limb_shift] = shift_left( &a_shifted[limb_shift], a, an, bit_shift );
+                if( a_shifted[t * n - 1] & 0x80000000U ) {
+                    ++t;
+                    a_shifted.resize( t * n, 0 );
+                }
+
+                // Divide [z, next block] by the divisor for each block, from the top down. The
+                // remainder of each step overwrites the top half of z, which is safe because
+                // divide_2n_by_n is finished reading its dividend by the time it stores it.
+                //
+                LimbVector quotient( t * n, 0 );
+                LimbVector z( 2 * n );
+                std::copy( a_shifted.begin( ) + ( t - 2 ) * n, a_shifted.end( ), z.begin( ) );
+                for( std::size_t i = t - 1; i > 0; ) {
+                    --i;
+                    divide_2n_by_n( &quotient[i * n], &z[n], z.data( ), b_shifted.data( ), n );
+                    if( i > 0 ) {
+                        std::copy( &a_shifted[( i - 1 ) * n], &a_shifted[i * n], z.begin( ) );
+                    }
+                }
+
+                std::copy( quotient.begin( ), quotient.begin( ) + ( an - bn + 1 ), q );
+
+                // The remainder is in the top half of z. Undo the shift.
+                shift_right( &z[n], &z[n], n, bit_shift );
+                std::copy( &z[n + limb_shift], &z[n + limb_shift] + bn, r );
+            }
+
+            //
+            // power_difference
+            //
+            // Sets r[0..rn) to |a b - B^k|, which must be less than B^(rn - 1), and returns true if
+            // a b >= B^k. Here a = a[0..an), b = b[0..bn), and k < an + bn. Only the low limbs of
+            // a b matter, so when it is faster a b is computed modulo B^wn - 1 for some wn >= rn
+            // (see multiply_wrapped). A negative difference then comes out as B^wn - 1 less its
+            // magnitude, which has a nonzero top limb.
+            //
+            bool power_difference( limb_type *r, std::size_t rn, const limb_type *a, std::size_t an,
+                const limb_type *b, std::size_t bn, std::size_t k )
+            {
+                const std::size_t wn = wrapped_size( rn );
+                if( wn != 0 && wn < an + bn && an <= wn && bn <= wn ) {
+                    LimbVector t( wn );
+                    multiply_wrapped( t.data( ), a, an, b, bn, wn );
+                    // Subtract B^(k mod wn). A borrow out of the top is worth -B^wn, which is -1.
+                    const std::size_t j = k % wn;
+                    if( sub_1( &t[j], &t[j], wn - j, 1 ) != 0 ) {
+                        sub_1( t.data( ), t.data( ), wn, 1 );
+                    }
+                    const bool above = ( t[wn - 1] == 0 );
+                    if( !above ) {
+                        for( std::size_t i = 0; i < rn; ++i ) t[i] = ~t[i];
+                    }
+                    std::copy( t.data( ), t.data( ) + rn, r );
+                    // A difference of zero may have come out as B^wn - 1.
+                    return above || normalized_size( r, rn ) == 0;
+                }
+
+                LimbVector product( an + bn );
+                multiply( product.data( ), a, an, b, bn );
+                const bool above = ( normalized_size( product.data( ), an + bn ) > k );
+                if( above ) {
+                    sub_1( &product[k], &product[k], an + bn - k, 1 );
+                }
+                else {
+                    for( std::size_t i = 0; i < k; ++i ) product[i] = ~product[i];
+                    add_1( product.data( ), product.data( ), k, 1 );
+                }
+                std::fill( r, r + rn, 0 );
+                std::copy( product.data( ), product.data( ) + std::min( rn, an + bn ), r );
+                return above;
+            }
+
+            //
+            // approximate_reciprocal
+            //
+            // Computes v[0..m + 2) where d = d[0..m) has its top bit set and floor(B^(2m) / d) - 2
+            // <= v <= floor(B^(2m) / d). Let T = B^(2m) / d. The reciprocal vh of the top h limbs
+            // of d (a little more than half of them) gives x = vh * B^l, l = m - h, within 4 B^l
+            // of T. One step of Newton's iteration, x + x (B^(2m) - x d) / B^(2m), is below T by
+            // (T - x)^2 / T < 16 / B^2 since h > m / 2 + 1. The step is rounded down, so it is
+            // never above T and at most two below.
+            //
+            void approximate_reciprocal( limb_type *v, const limb_type *d, std::size_t m )
+            {
+                if( m < newton_threshold( ) ) {
+                    LimbVector numerator( 2 * m + 1, 0 ), remainder( m );
+                    numerator[2 * m] = 1;
+                    divide( v, remainder.data( ), numerator.data( ), 2 * m + 1, d, m );
+                    return;
+                }
+
+                const std::size_t h = ( m + 1 ) / 2 + 1;
+                const std::size_t l = m - h;
+                LimbVector vh( h + 2 );
+                approximate_reciprocal( vh.data( ), d + l, h );
+                const std::size_t vn = normalized_size( vh.data( ), h + 1 );
+
+                // e = (B^(2m) - x d) / B^l = B^(m + h) - vh d. Its magnitude is less than 4 d.
+                LimbVector e( m + 2 );
+                const bool negative =
+                    power_difference( e.data( ), m + 2, vh.data( ), vn, d, m, m + h );
+
+                // The correction is x e / B^(2m - l) = vh e / B^(2h). The low h - 1 limbs of e
+                // change it by less than one, so they are left out.
+                //
+                const limb_type *e_high = &e[h - 1];
+                const std::size_t en = normalized_size( e_high, l + 2 );
+                std::fill( v, v + m + 2, 0 );
+                std::copy( vh.data( ), vh.data( ) + h + 1, v + l );
+                if( en != 0 ) {
+                    LimbVector product( vn + en );
+                    multiply( product.data( ), vh.data( ), vn, e_high, en );
+                    const limb_type *correction = &product[h + 1];
+                    const std::size_t cn = normalized_size( correction, vn + en - ( h + 1 ) );
+                    if( negative ) sub( v, v, m + 2, correction, cn );
+                    else add( v, v, m + 2, correction, cn );
+                }
+                // Leaving out the low limbs of e and rounding down make the correction up to two
+                // too small. Added, that keeps v below T. Subtracted, it must be made up for.
+                //
+                if( negative ) sub_1( v, v, m + 2, 2 );
+            }
+
+        } // End of anonymous namespace
+
+
+        //
+        // divide
+        //
+        // This is the entry point to the division engine. It selects an algorithm based on the
+        // size of the operands.
+        //
+        void divide( limb_type *q, limb_type *r,
+            const limb_type *a, std::size_t an, const limb_type *b, std::size_t bn )
+        {
+            if( bn == 1 ) {
+                r[0] = divide_1( q, a, an, b[0] );
+            }
+            else if( bn < BigIntTuning::burnikel_ziegler_threshold ||
+                     an - bn < BigIntTuning::burnikel_ziegler_threshold ) {
+                divide_knuth( q, r, a, an, b, bn );
+            }
+            else {
+                divide_burnikel_ziegler( q, r, a, an, b, bn );
+            }
+        }
+
+
+        //
+        // reciprocal
+        //
+        // Small divisors are handled by dividing. Large ones use Newton's iteration, which costs
+        // a few multiplications of the divisor's size, and then a final correction.
+        //
+        std::size_t reciprocal( limb_type *r, const limb_type *d, std::size_t m )
+        {
+            if( m < newton_threshold( ) ) {
+                LimbVector numerator( 2 * m + 1, 0 ), remainder( m );
+                numerator[2 * m] = 1;
+                std::fill( r, r + m + 2, 0 );
+                divide( r, remainder.data( ), numerator.data( ), 2 * m + 1, d, m );
+                return normalized_size( r, m + 2 );
+            }
+
+            // Let s be the number of leading zero bits in d. Then d' = d 2^s B has m + 1 limbs
+            // and its top bit set, and floor(B^(2m + 2) / d') / 2^(32 - s) = floor(B^(2m) / d).
+            //
+            const int shift = leading_zeros( d[m - 1] );
+            LimbVector normalized( m + 1, 0 ), v( m + 3 );
+            shift_left( &normalized[1], d, m, shift );
+            approximate_reciprocal( v.data( ), normalized.data( ), m + 1 );
+            if( shift == 0 ) {
+                std::copy( &v[1], &v[1] + ( m + 2 ), r );
+            }
+            else {
+                shift_right( v.data( ), v.data( ), m + 3, limb_bits - shift );
+                std::copy( v.data( ), v.data( ) + ( m + 2 ), r );
+            }
+
+            // Now r should be at most one too small. Correct it using the remainder B^(2m) - r d,
+            // which is negative if r is too large. Its magnitude is less than 3 d.
+            //
+            LimbVector remainder( m + 2 );
+            limb_type *p = remainder.data( );
+            const bool above =
+                power_difference( p, m + 2, r, normalized_size( r, m + 2 ), d, m, 2 * m );
+            if( above ) {
+                while( normalized_size( p, m + 2 ) != 0 ) {
+                    sub_1( r, r, m + 2, 1 );
+                    if( compare( p, normalized_size( p, m + 2 ), d, m ) <= 0 ) {
+                        sub_n( p, d, p, m );
+                        break;
+                    }
+                    sub( p, p, m + 2, d, m );
+                }
+            }
+            while( compare( p, normalized_size( p, m + 2 ), d, m ) >= 0 ) {
+                sub( p, p, m + 2, d, m );
+                add_1( r, r, m + 2, 1 );
+            }
+            return normalized_size( r, m + 2 );
+        }
+
+
+        //
+        // divide_barrett
+        //
+        // The quotient is estimated from the top of x times the reciprocal; the estimate is
+        // never too large and at most two too small (Handbook of Applied Cryptography,
+        // algorithm 14.42), which the final loop corrects.
+        //
+        void divide_barrett( limb_type *q, limb_type *r, const limb_type *x, std::size_t xn,
+            const limb_type *d, std::size_t m, const limb_type *mu, std::size_t mun,
+            limb_type *scratch )
+        {
+            const std::size_t qn = xn - m + 1;
+            limb_type *product   = scratch;
+            limb_type *back      = product + qn + mun;
+            limb_type *remainder = back + qn + m;
+
+            // estimate = ((x >> (m - 1) limbs) * mu) >> (m + 1) limbs. Since mu is at least B^m,
+            // the product has at least qn limbs above the ones discarded. The estimate is less
+            // than B^qn so any limbs above those are zero.
+            //
+            multiply( product, x + m - 1, qn, mu, mun );
+            std::copy( product + ( m + 1 ), product + ( m + 1 + qn ), q );
+
+            // remainder = x - estimate * d, which is less than 3d. That is less than B^(m + 1), so
+            // it can be computed modulo B^wn - 1 for any wn >= m + 2, if that is faster. Then
+            // the product's space is free for x modulo B^wn - 1, whose top half is added to its
+            // bottom half. A remainder of zero may come out as B^wn - 1.
+            //
+            const std::size_t wn = wrapped_size( m + 2 );
+            std::size_t rn = xn + 1;
+            if( wn != 0 && wn < qn + m && qn <= wn ) {
+                multiply_wrapped( back, q, qn, d, m, wn );
+                remainder = product;
+                rn = wn;
+                std::fill( remainder, remainder + wn, 0 );
+                std::copy( x, x + std::min( xn, wn ), remainder );
+                if( xn > wn && add( remainder, remainder, wn, x + wn, xn - wn ) != 0 ) {
+                    add_1( remainder, remainder, wn, 1 );
+                }
+                if( sub_n( remainder, remainder, back, wn ) != 0 ) {
+                    sub_1( remainder, remainder, wn, 1 );
+                }
+                if( remainder[wn - 1] != 0 ) std::fill( remainder, remainder + wn, 0 );
+            }
+            else {
+                multiply( back, q, qn, d, m );
+                std::copy( x, x + xn, remainder );
+                remainder[xn] = 0;
+                sub( remainder, remainder, xn + 1, back, normalized_size( back, qn + m ) );
+            }
+
+            while( compare( remainder, normalized_size( remainder, rn ), d, m ) >= 0 ) {
+                sub( remainder, remainder, rn, d, m );
+                add_1( q, q, qn, 1 );
+            }
+            std::copy( remainder, remainder + m, r );
+        }
+
+    } // End of namespace kernels
+} // End of namespace vtsu
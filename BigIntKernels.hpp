@@ -0,0 +1,401 @@
+/**************************************************************************
+FILE          : BigIntKernels.hpp
+PROGRAMMER    : Peter Chapin
+
+(C) Copyright 2006 by Peter C. Chapin
+
+This file contains the low level "kernels" used to implement the BigInt class. Each kernel works
+on raw arrays of limbs (least significant limb first) rather than on BigInt objects. This lets
+the higher level algorithms (multiplication, division, and so forth) operate on pieces of
+numbers without having to make copies of them.
+
+This header is an implementation detail of BigInt. Programs using BigInt should not need it.
+**************************************************************************/
+
+#ifndef BIGINTKERNELS_HPP
+#define BIGINTKERNELS_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include "BigInt.hpp"
+
+// On x86-64 the add-with-carry and subtract-with-borrow instructions are available as compiler
+// intrinsics. They let the addition and subtraction kernels work on two limbs at a time with the
+// carry kept in the processor's flags rather than recomputed with shifts. Other targets use the
+// portable loops.
+//
+#if defined( __x86_64__ ) || defined( _M_X64 )
+    #define VTSU_BIGINT_ADC 1
+    #if defined( _MSC_VER )
+        #include <intrin.h>
+    #else
+        #include <immintrin.h>
+    #endif
+#else
+    #define VTSU_BIGINT_ADC 0
+#endif
+
+namespace vtsu {
+    namespace kernels {
+
+        typedef BigInt::limb_type limb_type;
+        typedef BigInt::wide_type wide_type;
+
+        const int limb_bits = 32;
+
+        // Returns the number of limbs in a[0..n) after leading zeros are ignored.
+        inline std::size_t normalized_size( const limb_type *a, std::size_t n )
+        {
+            while( n > 0 && a[n - 1] == 0 ) --n;
+            return n;
+        }
+
+        // Compares a[0..n) with b[0..n). Returns -1, 0, or +1. Two limbs are compared at a time
+        // as one wide word, which compilers turn into a single 64 bit load and compare.
+        //
+        inline int compare_n( const limb_type *a, const limb_type *b, std::size_t n )
+        {
+            while( n >= 2 ) {
+                n -= 2;
+                wide_type x = ( static_cast<wide_type>( a[n + 1] ) << limb_bits ) | a[n];
+                wide_type y = ( static_cast<wide_type>( b[n + 1] ) << limb_bits ) | b[n];
+                if( x != y ) return ( x < y ) ? -1 : 1;
+            }
+            if( n == 1 && a[0] != b[0] ) return ( a[0] < b[0] ) ? -1 : 1;
+            return 0;
+        }
+
+        // Compares a[0..an) with b[0..bn) where neither has leading zeros.
+        inline int compare( const limb_type *a, std::size_t an, const limb_type *b, std::size_t bn )
+        {
+            if( an != bn ) return ( an < bn ) ? -1 : 1;
+            return compare_n( a, b, an );
+        }
+
+        // Returns the low half of the 128 bit product a * b and puts the high half in high. GCC
+        // and Clang provide a 128 bit type for this, which becomes a single instruction on 64 bit
+        // targets. Otherwise the product is built from four 32 bit products.
+        //
+        inline wide_type multiply_wide( wide_type a, wide_type b, wide_type &high )
+        {
+#if defined( __SIZEOF_INT128__ )
+            __extension__ typedef unsigned __int128 double_wide_type;
+            const double_wide_type product = static_cast<double_wide_type>( a ) * b;
+            high = static_cast<wide_type>( product >> 64 );
+            return static_cast<wide_type>( product );
+#else
+            const wide_type mask = 0xFFFFFFFFU;
+            const wide_type low_low   = ( a & mask ) * ( b & mask );
+            const wide_type low_high  = ( a & mask ) * ( b >> limb_bits );
+            const wide_type high_low  = ( a >> limb_bits ) * ( b & mask );
+            const wide_type high_high = ( a >> limb_bits ) * ( b >> limb_bits );
+            const wide_type middle = ( low_low >> limb_bits ) + ( low_high & mask ) + ( high_low & mask );
+            high = high_high + ( low_high >> limb_bits ) + ( high_low >> limb_bits ) + ( middle >> limb_bits );
+            return ( middle << limb_bits ) | ( low_low & mask );
+#endif
+        }
+
+#if VTSU_BIGINT_ADC
+        // Reads (or writes) two adjacent limbs as a single 64 bit word. The target is little
+        // endian so the lower limb ends up in the lower half of the word.
+        //
+        inline unsigned long long load_pair( const limb_type *p )
+        {
+            unsigned long long word;
+            std::memcpy( &word, p, sizeof( word ) );
+            return word;
+        }
+
+        inline void store_pair( limb_type *p, unsigned long long word )
+        {
+            std::memcpy( p, &word, sizeof( word ) );
+        }
+#endif
+
+        // r[0..n) = a[0..n) + b[0..n). Returns the carry out of the top limb. The result may
+        // overlap either operand exactly.
+        //
+        inline limb_type add_n( limb_type *r, const limb_type *a, const limb_type *b, std::size_t n )
+        {
+#if VTSU_BIGINT_ADC
+            // The loop is unrolled so that the loads for a block are issued before the carry
+            // chain that depends on them, and so that loop overhead is spread over eight limbs.
+            //
+            unsigned char carry = 0;
+            std::size_t i = 0;
+            for( ; i + 8 <= n; i += 8 ) {
+                unsigned long long a0 = load_pair( a + i ),     b0 = load_pair( b + i );
+                unsigned long long a1 = load_pair( a + i + 2 ), b1 = load_pair( b + i + 2 );
+                unsigned long long a2 = load_pair( a + i + 4 ), b2 = load_pair( b + i + 4 );
+                unsigned long long a3 = load_pair( a + i + 6 ), b3 = load_pair( b + i + 6 );
+                unsigned long long r0, r1, r2, r3;
+                carry = _addcarry_u64( carry, a0, b0, &r0 );
+                carry = _addcarry_u64( carry, a1, b1, &r1 );
+                carry = _addcarry_u64( carry, a2, b2, &r2 );
+                carry = _addcarry_u64( carry, a3, b3, &r3 );
+                store_pair( r + i, r0 );
+                store_pair( r + i + 2, r1 );
+                store_pair( r + i + 4, r2 );
+                store_pair( r + i + 6, r3 );
+            }
+            for( ; i < n; ++i ) {
+                carry = _addcarry_u32( carry, a[i], b[i], &r[i] );
+            }
+            return carry;
+#else
+            wide_type carry = 0;
+            for( std::size_t i = 0; i < n; ++i ) {
+                wide_type sum = static_cast<wide_type>( a[i] ) + b[i] + carry;
+                r[i]  = static_cast<limb_type>( sum );
+                carry = sum >> limb_bits;
+            }
+            return static_cast<limb_type>( carry );
+#endif
+        }
+
+        // r[0..n) = a[0..n) + value. Returns the carry out of the top limb.
+        inline limb_type add_1( limb_type *r, const limb_type *a, std::size_t n, limb_type value )
+        {
+            wide_type carry = value;
+            std::size_t i = 0;
+            for( ; carry != 0 && i < n; ++i ) {
+                wide_type sum = static_cast<wide_type>( a[i] ) + carry;
+                r[i]  = static_cast<limb_type>( sum );
+                carry = sum >> limb_bits;
+            }
+            if( r != a ) {
+                for( ; i < n; ++i ) r[i] = a[i];
+            }
+            return static_cast<limb_type>( carry );
+        }
+
+        // r[0..an) = a[0..an) + b[0..bn) where an >= bn. Returns the carry out of the top limb.
+        inline limb_type add(
+            limb_type *r, const limb_type *a, std::size_t an, const limb_type *b, std::size_t bn )
+        {
+            limb_type carry = add_n( r, a, b, bn );
+            return add_1( r + bn, a + bn, an - bn, carry );
+        }
+
+        // r[0..n) = a[0..n) - b[0..n). Returns the borrow out of the top limb. The result may
+        // overlap either operand exactly.
+        //
+        inline limb_type sub_n( limb_type *r, const limb_type *a, const limb_type *b, std::size_t n )
+        {
+#if VTSU_BIGINT_ADC
+            unsigned char borrow = 0;
+            std::size_t i = 0;
+            for( ; i + 8 <= n; i += 8 ) {
+                unsigned long long a0 = load_pair( a + i ),     b0 = load_pair( b + i );
+                unsigned long long a1 = load_pair( a + i + 2 ), b1 = load_pair( b + i + 2 );
+                unsigned long long a2 = load_pair( a + i + 4 ), b2 = load_pair( b + i + 4 );
+                unsigned long long a3 = load_pair( a + i + 6 ), b3 = load_pair( b + i + 6 );
+                unsigned long long r0, r1, r2, r3;
+                borrow = _subborrow_u64( borrow, a0, b0, &r0 );
+                borrow = _subborrow_u64( borrow, a1, b1, &r1 );
+                borrow = _subborrow_u64( borrow, a2, b2, &r2 );
+                borrow = _subborrow_u64( borrow, a3, b3, &r3 );
+                store_pair( r + i, r0 );
+                store_pair( r + i + 2, r1 );
+                store_pair( r + i + 4, r2 );
+                store_pair( r + i + 6, r3 );
+            }
+            for( ; i < n; ++i ) {
+                borrow = _subborrow_u32( borrow, a[i], b[i], &r[i] );
+            }
+            return borrow;
+#else
+            limb_type borrow = 0;
+            for( std::size_t i = 0; i < n; ++i ) {
+                wide_type difference = static_cast<wide_type>( a[i] ) - b[i] - borrow;
+                r[i]   = static_cast<limb_type>( difference );
+                borrow = static_cast<limb_type>( difference >> limb_bits ) & 1;
+            }
+            return borrow;
+#endif
+        }
+
+        // r[0..n) = a[0..n) - value. Returns the borrow out of the top limb.
+        inline limb_type sub_1( limb_type *r, const limb_type *a, std::size_t n, limb_type value )
+        {
+            limb_type borrow = value;
+            std::size_t i = 0;
+            for( ; borrow != 0 && i < n; ++i ) {
+                limb_type current = a[i];
+                r[i]   = current - borrow;
+                borrow = ( current < borrow ) ? 1 : 0;
+            }
+            if( r != a ) {
+                for( ; i < n; ++i ) r[i] = a[i];
+            }
+            return borrow;
+        }
+
+        // r[0..an) = a[0..an) - b[0..bn) where an >= bn. Returns the borrow out of the top limb.
+        inline limb_type sub(
+            limb_type *r, const limb_type *a, std::size_t an, const limb_type *b, std::size_t bn )
+        {
+            limb_type borrow = sub_n( r, a, b, bn );
+            return sub_1( r + bn, a + bn, an - bn, borrow );
+        }
+
+        // r[0..n) = a[0..n) * m. Returns the high limb of the product.
+        inline limb_type mul_1( limb_type *r, const limb_type *a, std::size_t n, limb_type m )
+        {
+            wide_type carry = 0;
+            for( std::size_t i = 0; i < n; ++i ) {
+                wide_type product = static_cast<wide_type>( a[i] ) * m + carry;
+                r[i]  = static_cast<limb_type>( product );
+                carry = product >> limb_bits;
+            }
+            return static_cast<limb_type>( carry );
+        }
+
+        // r[0..n) += a[0..n) * m. Returns the carry out of the top limb.
+        inline limb_type addmul_1( limb_type *r, const limb_type *a, std::size_t n, limb_type m )
+        {
+            wide_type carry = 0;
+            for( std::size_t i = 0; i < n; ++i ) {
+                wide_type product = static_cast<wide_type>( a[i] ) * m + r[i] + carry;
+                r[i]  = static_cast<limb_type>( product );
+                carry = product >> limb_bits;
+            }
+            return static_cast<limb_type>( carry );
+        }
+
+        // r[0..n) -= a[0..n) * m. Returns the borrow out of the top limb.
+        inline limb_type submul_1( limb_type *r, const limb_type *a, std::size_t n, limb_type m )
+        {
+            wide_type borrow = 0;
+            for( std::size_t i = 0; i < n; ++i ) {
+                wide_type product = static_cast<wide_type>( a[i] ) * m + borrow;
+                limb_type low = static_cast<limb_type>( product );
+                borrow = ( product >> limb_bits ) + ( r[i] < low ? 1 : 0 );
+                r[i] -= low;
+            }
+            return static_cast<limb_type>( borrow );
+        }
+
+        // Returns the number of leading zero bits in a limb. The limb must not be zero.
+        inline int leading_zeros( limb_type x )
+        {
+            int count = 0;
+            while( ( x & 0x80000000U ) == 0 ) {
+                x <<= 1;
+                ++count;
+            }
+            return count;
+        }
+
+        // r[0..n) = a[0..n) << shift where 0 <= shift < limb_bits. Returns the bits shifted out
+        // of the top limb. The result may overlap the operand exactly.
+        //
+        inline limb_type shift_left( limb_type *r, const limb_type *a, std::size_t n, int shift )
+        {
+            if( shift == 0 ) {
+                for( std::size_t i = n; i > 0; --i ) r[i - 1] = a[i - 1];
+                return 0;
+            }
+            limb_type out = 0;
+            for( std::size_t i = 0; i < n; ++i ) {
+                limb_type current = a[i];
+                r[i] = ( current << shift ) | out;
+                out  = current >> ( limb_bits - shift );
+            }
+            return out;
+        }
+
+        // r[0..n) = a[0..n) >> shift where 0 <= shift < limb_bits. The result may overlap the
+        // operand exactly.
+        //
+        inline void shift_right( limb_type *r, const limb_type *a, std::size_t n, int shift )
+        {
+            if( shift == 0 ) {
+                for( std::size_t i = 0; i < n; ++i ) r[i] = a[i];
+                return;
+            }
+            for( std::size_t i = 0; i < n; ++i ) {
+                limb_type high = ( i + 1 < n ) ? a[i + 1] << ( limb_bits - shift ) : 0;
+                r[i] = ( a[i] >> shift ) | high;
+            }
+        }
+
+        // q[0..n) = a[0..n) / d. Returns the remainder. The quotient may overlap the dividend.
+        inline limb_type divide_1( limb_type *q, const limb_type *a, std::size_t n, limb_type d )
+        {
+            wide_type remainder = 0;
+            for( std::size_t i = n; i > 0; --i ) {
+                wide_type current = ( remainder << limb_bits ) | a[i - 1];
+                q[i - 1]  = static_cast<limb_type>( current / d );
+                remainder = current % d;
+            }
+            return static_cast<limb_type>( remainder );
+        }
+
+        // r[0..an + bn) = a[0..an) * b[0..bn). Both operands must have at least one limb. The
+        // result must not overlap either operand. This function selects the best algorithm for
+        // the given operand sizes (see BigIntMultiply.cpp).
+        //
+        void multiply(
+            limb_type *r, const limb_type *a, std::size_t an, const limb_type *b, std::size_t bn );
+
+        // The largest value of an + bn that multiply_ntt can handle.
+        extern const std::size_t ntt_max_size;
+
+        // Like multiply but always uses the number theoretic transform (see BigIntNTT.cpp).
+        void multiply_ntt(
+            limb_type *r, const limb_type *a, std::size_t an, const limb_type *b, std::size_t bn );
+
+        // Returns the smallest size of at least n limbs that multiply_wrapped can use, or zero if
+        // n is too small for it to be worthwhile or too large for it to work.
+        //
+        std::size_t wrapped_size( std::size_t n );
+
+        // r[0..n) = a[0..an) * b[0..bn) modulo B^n - 1, where n is a size returned by
+        // wrapped_size and an and bn are at most n. The result may be B^n - 1, which is another
+        // form of zero. When an + bn is near 2n, this takes about half as long as multiply.
+        //
+        void multiply_wrapped( limb_type *r, const limb_type *a, std::size_t an,
+            const limb_type *b, std::size_t bn, std::size_t n );
+
+        // Divides a[0..an) by b[0..bn) where an >= bn and b[bn - 1] != 0. The quotient goes into
+        // q[0..an - bn + 1) and the remainder into r[0..bn). Neither output may overlap an input.
+        // This function selects the best algorithm for the given operand sizes (see
+        // BigIntDivide.cpp).
+        //
+        void divide( limb_type *q, limb_type *r,
+            const limb_type *a, std::size_t an, const limb_type *b, std::size_t bn );
+
+        // Computes floor(B^(2m) / d) where d = d[0..m) has a nonzero top limb and B is the limb
+        // base. The result goes into r[0..m + 2) and its normalized size is returned. This
+        // "reciprocal" of d is what divide_barrett needs.
+        //
+        std::size_t reciprocal( limb_type *r, const limb_type *d, std::size_t m );
+
+        // The number of limbs of scratch space that divide_barrett needs for an m limb divisor.
+        inline std::size_t barrett_scratch_size( std::size_t m ) { return 6 * m + 5; }
+
+        // Divides x[0..xn) by d[0..m) where m <= xn <= 2m, using the reciprocal mu[0..mun) of d
+        // computed by the function above. The quotient goes into q[0..xn - m + 1) and the
+        // remainder into r[0..m). This takes two multiplications, so it is much faster than
+        // divide when many numbers are divided by the same divisor. The scratch space must have
+        // barrett_scratch_size( m ) limbs. None of the arrays may overlap.
+        //
+        void divide_barrett( limb_type *q, limb_type *r, const limb_type *x, std::size_t xn,
+            const limb_type *d, std::size_t m, const limb_type *mu, std::size_t mun,
+            limb_type *scratch );
+
+        // Returns true if work on operands of the given size should be split among threads.
+        bool use_threads( std::size_t limb_count );
+
+        // Runs tasks[0..count) and returns when all of them are finished. The tasks run in
+        // parallel if BigInt is allowed to use more than one thread (see BigIntParallel.cpp).
+        // If any task throws an exception, one of the exceptions is rethrown here.
+        //
+        void parallel_invoke( const std::function<void( )> *tasks, std::size_t count );
+
+    } // End of namespace kernels
+} // End of namespace vtsu
+
+#endif
@@ -0,0 +1,360 @@
+/**************************************************************************
+FILE          : BigIntMultiply.cpp
+PROGRAMMER    : Peter Chapin
+
+(C) Copyright 2006 by Peter C. Chapin
+
+This file contains the multiplication engine used by BigInt. Four algorithms are provided:
+
++ Schoolbook multiplication. This is the method taught in grade school. It takes O(n^2) time
+  but it has very little overhead so it is the fastest method for small numbers.
+
++ Karatsuba multiplication. Each operand is split into two halves and the product is computed
+  using three half sized multiplications instead of four. It takes O(n^1.585) time.
+
++ Toom-3 multiplication. Each operand is split into three parts and the product is computed
+  using five third sized multiplications instead of nine. It takes O(n^1.465) time.
+
++ Number theoretic transform (NTT) multiplication. The product is computed as a convolution
+  using fast modular transforms. It takes O(n log n) time but has a large constant factor. See
+  BigIntNTT.cpp for the details.
+
+The function kernels::multiply selects an algorithm based on the size of the operands using the
+thresholds in BigIntTuning. The recursive algorithms call kernels::multiply for their sub-
+products so that each level of the recursion uses whatever method is best for its size. When the
+operands are large, the independent subproducts are computed in parallel (see
+BigIntParallel.cpp).
+**************************************************************************/
+
+#include <algorithm>
+#include <vector>
+#include "BigIntKernels.hpp"
+
+namespace vtsu {
+
+    // These defaults were chosen with the crossover suite of BigIntBench on a typical x86-64
+    // machine. Toom-3 starts to beat Karatsuba at about 768 limbs and NTT starts to beat Toom-3
+    // at about 8192 limbs. The NTT test in kernels::multiply comes first, so ntt_threshold must
+    // be above toom3_threshold or Toom-3 would never be used.
+    //
+    std::size_t BigIntTuning::karatsuba_threshold = 32;
+    std::size_t BigIntTuning::toom3_threshold     = 768;
+    std::size_t BigIntTuning::ntt_threshold       = 8192;
+
+    namespace kernels {
+        namespace {
+
+            typedef std::vector<limb_type> LimbVector;
+
+            //
+            // schoolbook
+            //
+            // The classic O(n^2) method. Each limb of b is multiplied by all of a and the
+            // partial product is added into the result at the appropriate offset. Here an >= bn
+            // so that the inner loop, which is the one that matters, is the long one.
+            //
+            void schoolbook(
+                limb_type *r, const limb_type *a, std::size_t an, const limb_type *b, std::size_t bn )
+            {
+                r[an] = mul_1( r, a, an, b[0] );
+                for( std::size_t j = 1; j < bn; ++j ) {
+                    r[an + j] = addmul_1( r + j, a, an, b[j] );
+                }
+            }
+
+
+            //
+            // unbalanced
+            //
+            // Handles the case where a is much longer than b. The long operand is cut into
+            // pieces the size of b and each piece is multiplied by b separately. This keeps the
+            // recursive algorithms, which work best on operands of similar size, efficient.
+            //
+            void unbalanced(
+                limb_type *r, const limb_type *a, std::size_t an, const limb_type *b, std::size_t bn )
+            {
+                LimbVector piece( 2 * bn );
+                std::fill( r, r + an + bn, 0 );
+                for( std::size_t offset = 0; offset < an; offset += bn ) {
+                    std::size_t chunk = std::min( bn, an - offset );
+                    multiply( piece.data( ), a + offset, chunk, b, bn );
+                    add( r + offset, r + offset, an + bn - offset, piece.data( ), chunk + bn );
+                }
+            }
+
+
+            // Runs the independent subproducts of a recursive algorithm. They are split among
+            // threads if the operands (of n limbs) are big enough.
+            //
+            void run_products( const std::function<void( )> *products, std::size_t count, std::size_t n )
+            {
+                if( use_threads( n ) ) {
+                    parallel_invoke( products, count );
+                }
+                else {
+                    for( std::size_t i = 0; i < count; ++i ) products[i]( );
+                }
+            }
+
+
+            //
+            // absolute_difference
+            //
+            // Computes r[0..xn) = |x - y| where y has yn <= xn limbs. Returns true if x < y.
+            //
+            bool absolute_difference(
+                limb_type *r, const limb_type *x, std::size_t xn, const limb_type *y, std::size_t yn )
+            {
+                bool x_smaller = false;
+                if( normalized_size( x + yn, xn - yn ) == 0 ) {
+                    x_smaller = compare_n( x, y, yn ) < 0;
+                }
+                if( x_smaller ) {
+                    sub_n( r, y, x, yn );
+                    std::fill( r + yn, r + xn, 0 );
+                }
+                else {
+                    sub( r, x, xn, y, yn );
+                }
+                return x_smaller;
+            }
+
+
+            //
+            // karatsuba
+            //
+            // Splits a = a1*B^h + a0 and b = b1*B^h + b0 (where B is the limb base) and uses the
+            // identity
+            //
+            //   a0*b1 + a1*b0 = a0*b0 + a1*b1 - (a0 - a1)*(b0 - b1)
+            //
+            // to get the middle term of the product with only one extra multiplication. Here
+            // an >= bn > h so both high parts are non-empty.
+            //
+            void karatsuba(
+                limb_type *r, const limb_type *a, std::size_t an, const limb_type *b, std::size_t bn )
+            {
+                const std::size_t h  = ( an + 1 ) / 2;
+                const std::size_t rn = an + bn;
+
+                LimbVector a_difference( h ), b_difference( h ), middle( 2 * h );
+                bool a_negative = absolute_difference( a_difference.data( ), a, h, a + h, an - h );
+                bool b_negative = absolute_difference( b_difference.data( ), b, h, b + h, bn - h );
+
+                // The low and high products go directly into their final positions. The three
+                // products are independent so they can be done in parallel.
+                //
+                const std::function<void( )> products[] = {
+                    [&]( ) { multiply( r, a, h, b, h ); },
+                    [&]( ) { multiply( r + 2 * h, a + h, an - h, b + h, bn - h ); },
+                    [&]( ) { multiply( middle.data( ), a_difference.data( ), h, b_difference.data( ), h ); }
+                };
+                run_products( products, 3, bn );
+
+                // sum = a0*b0 + a1*b1 -/+ |a0 - a1|*|b0 - b1|
+                LimbVector sum( 2 * h + 1 );
+                std::copy( r, r + 2 * h, sum.begin( ) );
+                sum[2 * h] = add( sum.data( ), sum.data( ), 2 * h, r + 2 * h, rn - 2 * h );
+                if( a_negative == b_negative ) {
+                    sub( sum.data( ), sum.data( ), 2 * h + 1, middle.data( ), 2 * h );
+                }
+                else {
+                    add( sum.data( ), sum.data( ), 2 * h + 1, middle.data( ), 2 * h );
+                }
+
+                std::size_t sum_size = normalized_size( sum.data( ), 2 * h + 1 );
+                add( r + h, r + h, rn - h, sum.data( ), sum_size );
+            }
+
+
+            // Toom-3 needs signed intermediate values. This is a minimal sign-magnitude number
+            // with just the operations needed by the evaluation and interpolation steps. The
+            // magnitude never has leading zeros.
+            //
+            struct Signed {
+                LimbVector magnitude;
+                bool       negative = false;
+            };
+
+            Signed make_signed( const limb_type *p, std::size_t n )
+            {
+                Signed result;
+                result.magnitude.assign( p, p + normalized_size( p, n ) );
+                return result;
+            }
+
+            // result = x + y (or x - y if subtract is true).
+            Signed add_signed( const Signed &x, const Signed &y, bool subtract = false )
+            {
+                bool y_negative = y.negative != subtract;
+                const LimbVector &xm = x.magnitude;
+                const LimbVector &ym = y.magnitude;
+
+                Signed result;
+                if( x.negative == y_negative ) {
+                    const LimbVector &longer  = ( xm.size( ) >= ym.size( ) ) ? xm : ym;
+                    const LimbVector &shorter = ( xm.size( ) >= ym.size( ) ) ? ym : xm;
+                    result.magnitude.resize( longer.size( ) + 1 );
+                    result.magnitude.back( ) = add( result.magnitude.data( ),
+                        longer.data( ), longer.size( ), shorter.data( ), shorter.size( ) );
+                    result.negative = x.negative;
+                }
+                else {
+                    int order = compare( xm.data( ), xm.size( ), ym.data( ), ym.size( ) );
+                    const LimbVector &larger  = ( order >= 0 ) ? xm : ym;
+                    const LimbVector &smaller = ( order >= 0 ) ? ym : xm;
+                    result.magnitude.resize( larger.size( ) );
+                    sub( result.magnitude.data( ),
+                        larger.data( ), larger.size( ), smaller.data( ), smaller.size( ) );
+                    result.negative = ( order >= 0 ) ? x.negative : y_negative;
+                }
+                result.magnitude.resize(
+                    normalized_size( result.magnitude.data( ), result.magnitude.size( ) ) );
+                if( result.magnitude.empty( ) ) result.negative = false;
+                return result;
+            }
+
+            Signed multiply_signed( const Signed &x, const Signed &y )
+            {
+                Signed result;
+                if( x.magnitude.empty( ) || y.magnitude.empty( ) ) return result;
+                result.magnitude.resize( x.magnitude.size( ) + y.magnitude.size( ) );
+                multiply( result.magnitude.data( ),
+                    x.magnitude.data( ), x.magnitude.size( ), y.magnitude.data( ), y.magnitude.size( ) );
+                result.magnitude.resize(
+                    normalized_size( result.magnitude.data( ), result.magnitude.size( ) ) );
+                result.negative = x.negative != y.negative;
+                return result;
+            }
+
+            // x = x * 2.
+            void double_signed( Signed &x )
+            {
+                limb_type carry = add_n(
+                    x.magnitude.data( ), x.magnitude.data( ), x.magnitude.data( ), x.magnitude.size( ) );
+                if( carry != 0 ) x.magnitude.push_back( carry );
+            }
+
+            // x = x / divisor where the division is known to be exact.
+            void divide_exact_signed( Signed &x, limb_type divisor )
+            {
+                wide_type remainder = 0;
+                for( std::size_t i = x.magnitude.size( ); i > 0; --i ) {
+                    wide_type current = ( remainder << limb_bits ) | x.magnitude[i - 1];
+                    x.magnitude[i - 1] = static_cast<limb_type>( current / divisor );
+                    remainder = current % divisor;
+                }
+                x.magnitude.resize( normalized_size( x.magnitude.data( ), x.magnitude.size( ) ) );
+                if( x.magnitude.empty( ) ) x.negative = false;
+            }
+
+
+            //
+            // toom3
+            //
+            // Splits each operand into three parts of k limbs and treats them as polynomials of
+            // degree two in B^k. The product polynomial (degree four) is evaluated at the points
+            // 0, 1, -1, -2, and infinity using five recursive multiplications and then recovered
+            // by interpolation. The evaluation and interpolation sequences are those described
+            // by Marco Bodrato, which use only additions, shifts, and one exact division by 3.
+            // Here an >= bn > 2k so every part is non-empty.
+            //
+            void toom3(
+                limb_type *r, const limb_type *a, std::size_t an, const limb_type *b, std::size_t bn )
+            {
+                const std::size_t k = ( an + 2 ) / 3;
+
+                Signed a0 = make_signed( a, k );
+                Signed a1 = make_signed( a + k, k );
+                Signed a2 = make_signed( a + 2 * k, an - 2 * k );
+                Signed b0 = make_signed( b, k );
+                Signed b1 = make_signed( b + k, k );
+                Signed b2 = make_signed( b + 2 * k, bn - 2 * k );
+
+                // Evaluation.
+                Signed p        = add_signed( a0, a2 );
+                Signed a_at_1   = add_signed( p, a1 );
+                Signed a_at_m1  = add_signed( p, a1, true );
+                Signed a_at_m2  = add_signed( a_at_m1, a2 );
+                double_signed( a_at_m2 );
+                a_at_m2 = add_signed( a_at_m2, a0, true );
+
+                p               = add_signed( b0, b2 );
+                Signed b_at_1   = add_signed( p, b1 );
+                Signed b_at_m1  = add_signed( p, b1, true );
+                Signed b_at_m2  = add_signed( b_at_m1, b2 );
+                double_signed( b_at_m2 );
+                b_at_m2 = add_signed( b_at_m2, b0, true );
+
+                // Pointwise multiplication.
+                Signed r0, r1, rm1, rm2, rinf;
+                const std::function<void( )> products[] = {
+                    [&]( ) { r0   = multiply_signed( a0, b0 ); },
+                    [&]( ) { r1   = multiply_signed( a_at_1, b_at_1 ); },
+                    [&]( ) { rm1  = multiply_signed( a_at_m1, b_at_m1 ); },
+                    [&]( ) { rm2  = multiply_signed( a_at_m2, b_at_m2 ); },
+                    [&]( ) { rinf = multiply_signed( a2, b2 ); }
+                };
+                run_products( products, 5, bn );
+
+                // Interpolation.
+                Signed r3 = add_signed( rm2, r1, true );
+                divide_exact_signed( r3, 3 );
+                r1 = add_signed( r1, rm1, true );
+                divide_exact_signed( r1, 2 );
+                Signed r2 = add_signed( rm1, r0, true );
+                r3 = add_signed( r2, r3, true );
+                divide_exact_signed( r3, 2 );
+                Signed twice_rinf = rinf;
+                double_signed( twice_rinf );
+                r3 = add_signed( r3, twice_rinf );
+                r2 = add_signed( add_signed( r2, r1 ), rinf, true );
+                r1 = add_signed( r1, r3, true );
+
+                // Recomposition. All the coefficients are now non-negative.
+                const std::size_t rn = an + bn;
+                const Signed *coefficients[] = { &r0, &r1, &r2, &r3, &rinf };
+                std::fill( r, r + rn, 0 );
+                for( std::size_t i = 0; i < 5; ++i ) {
+                    const LimbVector &c = coefficients[i]->magnitude;
+                    if( c.empty( ) ) continue;
+                    add( r + i * k, r + i * k, rn - i * k, c.data( ), c.size( ) );
+                }
+            }
+
+        } // End of anonymous namespace
+
+
+        //
+        // multiply
+        //
+        // This is the entry point to the multiplication engine. It selects an algorithm based
+        // on the size of the operands.
+        //
+        void multiply(
+            limb_type *r, const limb_type *a, std::size_t an, const limb_type *b, std::size_t bn )
+        {
+            if( an < bn ) {
+                std::swap( a, b );
+                std::swap( an, bn );
+            }
+
+            if( bn < 2 || bn < BigIntTuning::karatsuba_threshold ) {
+                schoolbook( r, a, an, b, bn );
+            }
+            else if( bn >= BigIntTuning::ntt_threshold && an + bn <= ntt_max_size ) {
+                multiply_ntt( r, a, an, b, bn );
+            }
+            else if( bn <= ( an + 1 ) / 2 ) {
+                unbalanced( r, a, an, b, bn );
+            }
+            else if( bn < BigIntTuning::toom3_threshold || bn <= 2 * ( ( an + 2 ) / 3 ) ) {
+                karatsuba( r, a, an, b, bn );
+            }
+            else {
+                toom3( r, a, an, b, bn );
+            }
+        }
+
+    } // End of namespace kernels
+} // End of namespace vtsu
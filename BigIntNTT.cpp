@@ -0,0 +1,356 @@
+/**************************************************************************
+FILE          : BigIntNTT.cpp
+PROGRAMMER    : Peter Chapin
+
+(C) Copyright 2006 by Peter C. Chapin
+
+This file contains the number theoretic transform (NTT) multiplication used by BigInt for very
+large operands. Each operand is treated as a polynomial whose coefficients are its limbs. The
+product of the operands is then the convolution of the coefficient sequences (followed by carry
+propagation), and a convolution can be computed in O(n log n) time using a fast transform.
+
+An NTT is a fast Fourier transform done in modular arithmetic rather than with complex numbers,
+so it is exact. Three primes of the form c*2^k + 1 are used. Each convolution coefficient is at
+most min(an, bn) * (2^32 - 1)^2, which is less than the product of the three primes for all
+supported sizes, so the true coefficients can be recovered from the three modular results with
+the Chinese Remainder Theorem. The result is bit-for-bit identical to schoolbook multiplication.
+
+The transform length is limited by the largest power of two that divides p - 1 for all three
+primes. That is 2^23, so the operands together can have at most 2^23 limbs. Larger products are
+broken down by the other algorithms in BigIntMultiply.cpp before they get here.
+
+The convolution is cyclic: coefficients past the end of the transform wrap around to the
+start. Normally the transform is made long enough that nothing wraps. When only the product
+modulo B^n - 1 is wanted (B is the limb base), the wrapping does the reduction for free, since
+B^n = 1 modulo B^n - 1. Then the transform needs to be only half as long.
+**************************************************************************/
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "BigIntKernels.hpp"
+
+namespace vtsu {
+    namespace kernels {
+
+        const std::size_t ntt_max_size = std::size_t( 1 ) << 23;
+
+        namespace {
+
+            typedef std::vector<std::uint32_t> Residues;
+
+            // Returns -P^-1 mod 2^32 for an odd P, by Newton's iteration for P^-1. Each step
+            // doubles the number of correct bits.
+            //
+            constexpr std::uint32_t negative_inverse( std::uint32_t P )
+            {
+                std::uint32_t x = P;
+                for( int i = 0; i < 4; ++i ) x *= 2 - P * x;
+                return 0U - x;
+            }
+
+            //
+            // ModularField
+            //
+            // Arithmetic modulo the prime P, where G is a primitive root of P. Making P a
+            // template parameter lets the compiler replace the division in each % operation with
+            // a much cheaper multiplication by a constant.
+            //
+            template< std::uint32_t P, std::uint32_t G >
+            struct ModularField {
+                static const std::uint32_t prime = P;
+
+                static std::uint32_t multiply( std::uint32_t x, std::uint32_t y )
+                    { return static_cast<std::uint32_t>( static_cast<std::uint64_t>( x ) * y % P ); }
+
+                static std::uint32_t add( std::uint32_t x, std::uint32_t y )
+                    { std::uint32_t sum = x + y; return ( sum >= P ) ? sum - P : sum; }
+
+                static std::uint32_t subtract( std::uint32_t x, std::uint32_t y )
+                    { return ( x >= y ) ? x - y : x + P - y; }
+
+                static std::uint32_t power( std::uint32_t base, std::uint64_t exponent )
+                {
+                    std::uint32_t result = 1;
+                    while( exponent != 0 ) {
+                        if( exponent & 1 ) result = multiply( result, base );
+                        base = multiply( base, base );
+                        exponent >>= 1;
+                    }
+                    return result;
+                }
+
+                static std::uint32_t inverse( std::uint32_t x )
+                    { return power( x, P - 2 ); }
+
+                // The transforms do their multiplications in Montgomery form, which replaces the
+                // division in x * y % P with two more multiplications and a shift. With R = 2^32,
+                // montgomery_multiply( x, y ) is x * y / R (mod P). The twiddle factors are stored
+                // premultiplied by R, so multiplying a plain value by one of them gives a plain
+                // result. The pointwise products in convolve do pick up a factor of 1/R; that is
+                // corrected along with the final scaling of the inverse transform. The constant
+                // p_prime is -P^-1 mod R, worked out by the compiler.
+                //
+                static constexpr std::uint32_t p_prime = negative_inverse( P );
+                static_assert( static_cast<std::uint32_t>( P * p_prime ) == 0xFFFFFFFFU,
+                               "p_prime is not -1/P mod 2^32" );
+
+                static std::uint32_t montgomery_multiply( std::uint32_t x, std::uint32_t y )
+                {
+                    std::uint64_t product = static_cast<std::uint64_t>( x ) * y;
+                    std::uint32_t m = static_cast<std::uint32_t>( product ) * p_prime;
+                    std::uint32_t t = static_cast<std::uint32_t>(
+                        ( product + static_cast<std::uint64_t>( m ) * P ) >> 32 );
+                    return ( t >= P ) ? t - P : t;
+                }
+
+                // Returns x * R mod P.
+                static std::uint32_t to_montgomery( std::uint32_t x )
+                    { return static_cast<std::uint32_t>( ( static_cast<std::uint64_t>( x ) << 32 ) % P ); }
+
+                //
+                // make_roots
+                //
+                // Precomputes the powers of a primitive nth root of unity needed by each stage of a
+                // transform of length n (a power of two). The powers for the stage that combines
+                // blocks of length 2h are stored contiguously starting at index h so that the inner
+                // loops walk through memory sequentially. Each smaller stage uses every other power
+                // from the stage above it.
+                //
+                static Residues make_roots( std::size_t n, bool inverse_roots )
+                {
+                    std::uint32_t root = power( G, ( P - 1 ) / n );
+                    if( inverse_roots ) root = inverse( root );
+                    Residues roots( std::max<std::size_t>( n, 2 ) );
+                    roots[n / 2] = 1;
+                    for( std::size_t k = 1; k < n / 2; ++k ) {
+                        roots[n / 2 + k] = multiply( roots[n / 2 + k - 1], root );
+                    }
+                    for( std::size_t k = 0; k < n / 2; ++k ) {
+                        roots[n / 2 + k] = to_montgomery( roots[n / 2 + k] );
+                    }
+                    for( std::size_t half = n / 4; half >= 1; half /= 2 ) {
+                        for( std::size_t k = 0; k < half; ++k ) roots[half + k] = roots[2 * half + 2 * k];
+                    }
+                    return roots;
+                }
+
+                //
+                // forward_transform
+                //
+                // An in-place decimation in frequency transform of length n. The input is in
+                // natural order and the output is left in bit reversed order. That is fine here
+                // because the transformed values are only multiplied pointwise and then given to
+                // inverse_transform, which expects bit reversed input. Skipping the reordering
+                // saves two passes over the data with very poor locality.
+                //
+                static void forward_transform( Residues &data, std::size_t n )
+                {
+                    Residues roots = make_roots( n, false );
+                    for( std::size_t half = n / 2; half >= 1; half /= 2 ) {
+                        const std::uint32_t *stage_roots = &roots[half];
+                        for( std::size_t start = 0; start < n; start += 2 * half ) {
+                            std::uint32_t *low  = &data[start];
+                            std::uint32_t *high = &data[start + half];
+                            for( std::size_t k = 0; k < half; ++k ) {
+                                std::uint32_t u = low[k];
+                                std::uint32_t v = high[k];
+                                low[k]  = add( u, v );
+                                high[k] = montgomery_multiply( subtract( u, v ), stage_roots[k] );
+                            }
+                        }
+                    }
+                }
+
+                //
+                // inverse_transform
+                //
+                // An in-place decimation in time inverse transform of length n. The input is in bit
+                // reversed order and the output is in natural order. Each output is then multiplied
+                // (in Montgomery form) by scale.
+                //
+                static void inverse_transform( Residues &data, std::size_t n, std::uint32_t scale )
+                {
+                    Residues roots = make_roots( n, true );
+                    for( std::size_t half = 1; half < n; half <<= 1 ) {
+                        const std::uint32_t *stage_roots = &roots[half];
+                        for( std::size_t start = 0; start < n; start += 2 * half ) {
+                            std::uint32_t *low  = &data[start];
+                            std::uint32_t *high = &data[start + half];
+                            for( std::size_t k = 0; k < half; ++k ) {
+                                std::uint32_t u = low[k];
+                                std::uint32_t v = montgomery_multiply( high[k], stage_roots[k] );
+                                low[k]  = add( u, v );
+                                high[k] = subtract( u, v );
+                            }
+                        }
+                    }
+
+                    for( std::size_t i = 0; i < n; ++i ) data[i] = montgomery_multiply( data[i], scale );
+                }
+
+                //
+                // convolve
+                //
+                // Computes the cyclic convolution of a and b modulo P using transforms of length n.
+                // The result has n elements.
+                //
+                static Residues convolve(
+                    const limb_type *a, std::size_t an, const limb_type *b, std::size_t bn, std::size_t n )
+                {
+                    Residues fa( n, 0 );
+                    for( std::size_t i = 0; i < an; ++i ) fa[i] = a[i] % P;
+                    forward_transform( fa, n );
+
+                    // Squaring is common (think exponentiation) and needs only one transform. The
+                    // pointwise products pick up a factor of 1/R from Montgomery multiplication.
+                    //
+                    if( a == b && an == bn ) {
+                        for( std::size_t i = 0; i < n; ++i ) fa[i] = montgomery_multiply( fa[i], fa[i] );
+                    }
+                    else {
+                        Residues fb( n, 0 );
+                        for( std::size_t i = 0; i < bn; ++i ) fb[i] = b[i] % P;
+                        forward_transform( fb, n );
+                        for( std::size_t i = 0; i < n; ++i ) fa[i] = montgomery_multiply( fa[i], fb[i] );
+                    }
+
+                    // The final scaling removes both the factor of n from the inverse transform and
+                    // the factor of 1/R from the pointwise products. In Montgomery form that means
+                    // multiplying by (R / n) * R.
+                    //
+                    std::uint32_t scale = to_montgomery( to_montgomery(
+                        inverse( static_cast<std::uint32_t>( n ) ) ) );
+                    inverse_transform( fa, n, scale );
+                    return fa;
+                }
+            };
+
+            // All three primes have 3 as a primitive root.
+            typedef ModularField< 998244353, 3 > Field1;   // 119 * 2^23 + 1
+            typedef ModularField< 167772161, 3 > Field2;   //   5 * 2^25 + 1
+            typedef ModularField< 469762049, 3 > Field3;   //   7 * 2^26 + 1
+
+            //
+            // convolve_limbs
+            //
+            // Computes the cyclic convolution of a[0..an) and b[0..bn) with transforms of length n,
+            // using three modular convolutions that are combined with Garner's form of the Chinese
+            // Remainder Theorem. The coefficients, with carries propagated, go into r[0..rn). The
+            // carry out of r[rn - 1] is returned.
+            //
+            wide_type convolve_limbs( limb_type *r, std::size_t rn, const limb_type *a,
+                std::size_t an, const limb_type *b, std::size_t bn, std::size_t n )
+            {
+                // The three convolutions are independent so they can be done in parallel.
+                Residues r1, r2, r3;
+                const std::function<void( )> convolutions[] = {
+                    [&]( ) { r1 = Field1::convolve( a, an, b, bn, n ); },
+                    [&]( ) { r2 = Field2::convolve( a, an, b, bn, n ); },
+                    [&]( ) { r3 = Field3::convolve( a, an, b, bn, n ); }
+                };
+                if( use_threads( bn ) ) {
+                    parallel_invoke( convolutions, 3 );
+                }
+                else {
+                    for( const std::function<void( )> &convolution : convolutions ) convolution( );
+                }
+
+                const std::uint64_t p1 = Field1::prime;
+                const std::uint64_t p2 = Field2::prime;
+                const std::uint64_t p1_p2 = p1 * p2;
+                const std::uint32_t p1_inverse    =
+                    Field2::inverse( static_cast<std::uint32_t>( p1 % p2 ) );
+                const std::uint32_t p1_p2_inverse =
+                    Field3::inverse( static_cast<std::uint32_t>( p1_p2 % Field3::prime ) );
+                const wide_type p1_p2_low  = p1_p2 & 0xFFFFFFFFU;
+                const wide_type p1_p2_high = p1_p2 >> limb_bits;
+
+                // Reconstruct each coefficient (up to 87 bits) and propagate carries into the
+                // result. The carry is always less than 2^57 so it fits comfortably in a wide_type.
+                //
+                wide_type carry = 0;
+                for( std::size_t i = 0; i < rn; ++i ) {
+                    wide_type coefficient_low = 0, coefficient_high = 0;
+                    if( i < n ) {
+                        std::uint32_t x1 = r1[i];
+                        std::uint32_t k2 = Field2::multiply(
+                            Field2::subtract( r2[i], x1 % Field2::prime ), p1_inverse );
+                        std::uint64_t x2 = x1 + p1 * k2;
+                        std::uint32_t k3 = Field3::multiply(
+                            Field3::subtract(
+                                r3[i], static_cast<std::uint32_t>( x2 % Field3::prime ) ),
+                            p1_p2_inverse );
+
+                        // coefficient = x2 + p1_p2 * k3, split at bit 32.
+                        wide_type low  = x2 + p1_p2_low * k3;
+                        wide_type high = p1_p2_high * k3;
+                        coefficient_low  = low & 0xFFFFFFFFU;
+                        coefficient_high = ( low >> limb_bits ) + high;
+                    }
+                    wide_type sum = coefficient_low + ( carry & 0xFFFFFFFFU );
+                    r[i]  = static_cast<limb_type>( sum );
+                    carry = ( carry >> limb_bits ) + ( sum >> limb_bits ) + coefficient_high;
+                }
+                return carry;
+            }
+
+        } // End of anonymous namespace
+
+
+        //
+        // multiply_ntt
+        //
+        // Computes r[0..an + bn) = a[0..an) * b[0..bn). Requires an + bn to be at most
+        // ntt_max_size. The transform is long enough that no coefficient wraps around, so the
+        // final carry is zero.
+        //
+        void multiply_ntt(
+            limb_type *r, const limb_type *a, std::size_t an, const limb_type *b, std::size_t bn )
+        {
+            const std::size_t rn = an + bn;
+            std::size_t n = 1;
+            while( n < rn - 1 ) n <<= 1;
+            convolve_limbs( r, rn, a, an, b, bn, n );
+        }
+
+
+        //
+        // wrapped_size
+        //
+        // The transform length must be a power of two. It is also limited to half the usual
+        // maximum: a wrapped coefficient is a sum of up to n products of limbs rather than
+        // min(an, bn) of them, and it must still be less than the product of the three primes.
+        //
+        std::size_t wrapped_size( std::size_t n )
+        {
+            if( n < BigIntTuning::ntt_threshold ) return 0;
+            std::size_t size = 1;
+            while( size < n ) size <<= 1;
+            return ( size <= ntt_max_size / 2 ) ? size : 0;
+        }
+
+
+        //
+        // multiply_wrapped
+        //
+        // The carry out of the top limb is worth B^n, which is 1 modulo B^n - 1, so it is added
+        // back in at the bottom. That can carry out of the top limb again only if the sum was
+        // small, in which case adding that carry back in can't.
+        //
+        void multiply_wrapped( limb_type *r, const limb_type *a, std::size_t an,
+            const limb_type *b, std::size_t bn, std::size_t n )
+        {
+            if( an < bn ) {
+                std::swap( a, b );
+                std::swap( an, bn );
+            }
+            const wide_type carry = convolve_limbs( r, n, a, an, b, bn, n );
+            const limb_type carry_limbs[] = {
+                static_cast<limb_type>( carry ), static_cast<limb_type>( carry >> limb_bits ) };
+            if( add( r, r, n, carry_limbs, 2 ) != 0 ) add_1( r, r, n, 1 );
+        }
+
+    } // End of namespace kernels
+} // End of namespace vtsu
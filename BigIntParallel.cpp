@@ -0,0 +1,235 @@
+/**************************************************************************
+FILE          : BigIntParallel.cpp
+PROGRAMMER    : Peter Chapin
+
+(C) Copyright 2006 by Peter C. Chapin
+
+This file contains the thread pool used to spread large BigInt computations over several
+processor cores.
+
+The pool uses "work stealing." Each worker thread has its own queue of tasks. A thread that
+splits its work into tasks puts them on its own queue and then starts on the first one itself.
+Idle threads take (steal) tasks from the far end of the other queues. While a thread waits for
+its tasks to finish, it runs other queued tasks instead of sleeping. This matters because the
+algorithms that use the pool are recursive: a task may split its own work into more tasks and
+wait for them, and if waiting threads did nothing the pool could run out of threads.
+**************************************************************************/
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "BigIntKernels.hpp"
+
+namespace vtsu {
+
+    // The threshold hasn't been tuned since BigIntBench was run on a single core machine. It
+    // is large enough that the cost of handing out tasks is small compared to the work.
+    //
+    std::size_t BigIntTuning::parallel_threshold = 1024;
+    unsigned    BigIntTuning::thread_count       = 0;
+
+    namespace kernels {
+        namespace {
+
+            // All the tasks given to the pool by one call of ThreadPool::run.
+            struct TaskGroup {
+                std::atomic<std::size_t> pending;  // Tasks not yet finished.
+                std::mutex               lock;     // Protects error.
+                std::exception_ptr       error;    // The first exception thrown by a task.
+            };
+
+            struct Job {
+                const std::function<void( )> *task;
+                TaskGroup                    *group;
+            };
+
+            // The index of the pool's queue that belongs to the current thread.
+            thread_local std::size_t home_queue = static_cast<std::size_t>( -1 );
+
+
+            class ThreadPool {
+            public:
+                explicit ThreadPool( unsigned worker_count );
+               ~ThreadPool( );
+
+                void run( const std::function<void( )> *tasks, std::size_t count );
+
+            private:
+                struct Queue {
+                    std::mutex      lock;
+                    std::deque<Job> jobs;
+                };
+
+                // One queue for each worker and one more shared by all other threads.
+                std::vector<std::unique_ptr<Queue>> queues;
+                std::vector<std::thread>            threads;
+
+                std::atomic<std::size_t> queued;     // Jobs in all the queues.
+                std::mutex               sleep_lock;
+                std::condition_variable  wake;
+                bool                     stopping;   // Protected by sleep_lock.
+
+                bool run_one( std::size_t home );
+                void work( std::size_t index );
+            };
+
+
+            ThreadPool::ThreadPool( unsigned worker_count ) : queued( 0 ), stopping( false )
+            {
+                for( unsigned i = 0; i <= worker_count; ++i ) {
+                    queues.emplace_back( new Queue );
+                }
+                for( unsigned i = 0; i < worker_count; ++i ) {
+                    threads.emplace_back( &ThreadPool::work, this, i );
+                }
+            }
+
+
+            ThreadPool::~ThreadPool( )
+            {
+                {
+                    std::lock_guard<std::mutex> guard( sleep_lock );
+                    stopping = true;
+                }
+                wake.notify_all( );
+                for( std::thread &thread : threads ) thread.join( );
+            }
+
+
+            //
+            // ThreadPool::run_one
+            //
+            // Runs one queued job if there is one. The thread's own queue is used as a stack so
+            // that it works on its most recent (smallest) tasks first. Jobs are stolen from the
+            // other end of the other queues since the oldest tasks are the biggest, which
+            // keeps the number of steals low.
+            //
+            bool ThreadPool::run_one( std::size_t home )
+            {
+                if( queued.load( std::memory_order_relaxed ) == 0 ) return false;
+
+                Job job = { nullptr, nullptr };
+                for( std::size_t i = 0; i < queues.size( ) && job.task == nullptr; ++i ) {
+                    Queue &queue = *queues[( home + i ) % queues.size( )];
+                    std::lock_guard<std::mutex> guard( queue.lock );
+                    if( queue.jobs.empty( ) ) continue;
+                    if( i == 0 ) {
+                        job = queue.jobs.back( );
+                        queue.jobs.pop_back( );
+                    }
+                    else {
+                        job = queue.jobs.front( );
+                        queue.jobs.pop_front( );
+                    }
+                }
+                if( job.task == nullptr ) return false;
+                queued.fetch_sub( 1, std::memory_order_relaxed );
+
+                try {
+                    ( *job.task )( );
+                }
+                catch( ... ) {
+                    std::lock_guard<std::mutex> guard( job.group->lock );
+                    if( !job.group->error ) job.group->error = std::current_exception( );
+                }
+                job.group->pending.fetch_sub( 1, std::memory_order_release );
+                return true;
+            }
+
+
+            void ThreadPool::work( std::size_t index )
+            {
+                home_queue = index;
+                for( ;; ) {
+                    if( run_one( index ) ) continue;
+
+                    std::unique_lock<std::mutex> guard( sleep_lock );
+                    wake.wait( guard, [this]( ) { return stopping || queued.load( ) > 0; } );
+                    if( stopping ) return;
+                }
+            }
+
+
+            //
+            // ThreadPool::run
+            //
+            // Queues all the tasks but the first, runs the first one, and then helps out until
+            // all of them are done.
+            //
+            void ThreadPool::run( const std::function<void( )> *tasks, std::size_t count )
+            {
+                std::size_t home = ( home_queue < queues.size( ) ) ? home_queue : queues.size( ) - 1;
+
+                TaskGroup group;
+                group.pending.store( count - 1 );
+                {
+                    Queue &queue = *queues[home];
+                    std::lock_guard<std::mutex> guard( queue.lock );
+                    for( std::size_t i = 1; i < count; ++i ) {
+                        queue.jobs.push_back( Job{ &tasks[i], &group } );
+                    }
+                }
+                queued.fetch_add( count - 1 );
+                {
+                    // Taking the lock ensures that no worker is between checking for jobs and
+                    // going to sleep, which would make it miss the notification.
+                    std::lock_guard<std::mutex> guard( sleep_lock );
+                }
+                wake.notify_all( );
+
+                try {
+                    tasks[0]( );
+                }
+                catch( ... ) {
+                    std::lock_guard<std::mutex> guard( group.lock );
+                    if( !group.error ) group.error = std::current_exception( );
+                }
+
+                while( group.pending.load( std::memory_order_acquire ) != 0 ) {
+                    if( !run_one( home ) ) std::this_thread::yield( );
+                }
+                if( group.error ) std::rethrow_exception( group.error );
+            }
+
+
+            // Returns the number of threads BigInt should use.
+            unsigned thread_count( )
+            {
+                unsigned count = BigIntTuning::thread_count;
+                if( count == 0 ) count = std::thread::hardware_concurrency( );
+                return ( count == 0 ) ? 1 : count;
+            }
+
+        } // End of anonymous namespace
+
+
+        bool use_threads( std::size_t limb_count )
+        {
+            return limb_count >= BigIntTuning::parallel_threshold && thread_count( ) > 1;
+        }
+
+
+        //
+        // parallel_invoke
+        //
+        // The pool is created the first time it is needed. The calling thread does some of the
+        // work, so the pool has one thread less than the number BigInt should use.
+        //
+        void parallel_invoke( const std::function<void( )> *tasks, std::size_t count )
+        {
+            const unsigned threads = thread_count( );
+            if( threads <= 1 || count <= 1 ) {
+                for( std::size_t i = 0; i < count; ++i ) tasks[i]( );
+                return;
+            }
+            static ThreadPool pool( threads - 1 );
+            pool.run( tasks, count );
+        }
+
+    } // End of namespace kernels
+} // End of namespace vtsu
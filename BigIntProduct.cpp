@@ -0,0 +1,133 @@
+/**************************************************************************
+FILE          : BigIntProduct.cpp
+PROGRAMMER    : Peter Chapin
+
+(C) Copyright 2006 by Peter C. Chapin
+
+This file contains functions that multiply many values together: general products, factorials,
+and binomial coefficients.
+
+Multiplying a list of values from left to right is slow because the running product becomes
+large while each new factor stays small, so almost all the multiplications are lopsided. A
+balanced "product tree" multiplies the factors in pairs, then multiplies those products in
+pairs, and so on. The total work is then dominated by a few multiplications of large numbers of
+equal size, which is exactly where the fast multiplication algorithms shine. The two halves of
+a tree are independent, so large trees are also split among threads.
+**************************************************************************/
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+#include "BigInt.hpp"
+#include "BigIntKernels.hpp"
+
+namespace vtsu {
+
+    namespace {
+
+        // Products with at most this many factors are done from left to right. There is no
+        // point in building a tree when all the factors are small.
+        //
+        const std::size_t leaf_size = 16;
+
+        // Returns the BigInt with the given value, which might not fit in a long.
+        BigInt make_big( unsigned long value )
+        {
+            if( value <= static_cast<unsigned long>( LONG_MAX ) ) return static_cast<long>( value );
+            BigInt result( static_cast<long>( value >> 1 ) );
+            result *= 2;
+            if( value & 1 ) result += 1;
+            return result;
+        }
+
+        //
+        // consecutive_factors
+        //
+        // Returns factors whose product is first * (first + 1) * ... * last. Consecutive
+        // numbers are multiplied together in ordinary arithmetic for as long as the product
+        // fits in a long, so there are far fewer factors than numbers.
+        //
+        std::vector<BigInt> consecutive_factors( unsigned long first, unsigned long last )
+        {
+            std::vector<BigInt> factors;
+            if( first > last ) return factors;
+
+            const unsigned long limit = LONG_MAX;
+            unsigned long packed = 1;
+            for( unsigned long i = first; ; ++i ) {
+                if( packed > limit / i ) {
+                    factors.push_back( make_big( packed ) );
+                    packed = 1;
+                }
+                if( packed == 1 && i > limit ) factors.push_back( make_big( i ) );
+                else packed *= i;
+                if( i == last ) break;
+            }
+            if( packed != 1 ) factors.push_back( make_big( packed ) );
+            return factors;
+        }
+
+    } // End of anonymous namespace
+
+
+    //
+    // BigInt product( const BigInt *, const BigInt * )
+    //
+    // The size of each half, in limbs, decides whether the halves are computed in parallel.
+    // The factors of a typical product are all about the same size, so splitting the range
+    // in the middle balances the tree.
+    //
+    BigInt product( const BigInt *first, const BigInt *last )
+    {
+        const std::size_t count = static_cast<std::size_t>( last - first );
+        if( count <= leaf_size ) {
+            BigInt result( 1 );
+            for( const BigInt *p = first; p != last; ++p ) result *= *p;
+            return result;
+        }
+
+        const BigInt *middle = first + count / 2;
+        std::size_t limb_count = 0;
+        for( const BigInt *p = first; p != last; ++p ) limb_count += p->limbs.size( );
+
+        BigInt left, right;
+        const std::function<void( )> halves[] = {
+            [&]( ) { left  = product( first, middle ); },
+            [&]( ) { right = product( middle, last ); }
+        };
+        if( kernels::use_threads( limb_count / 2 ) ) {
+            kernels::parallel_invoke( halves, 2 );
+        }
+        else {
+            halves[0]( );
+            halves[1]( );
+        }
+        left *= right;
+        return left;
+    }
+
+
+    BigInt factorial( unsigned long n )
+    {
+        return product( consecutive_factors( 2, n ) );
+    }
+
+
+    //
+    // BigInt binomial( unsigned long, unsigned long )
+    //
+    // Uses n choose k = (n - k + 1) * ... * n / k!, where k is replaced by n - k if that is
+    // smaller. The division is exact.
+    //
+    BigInt binomial( unsigned long n, unsigned long k )
+    {
+        if( k > n ) return 0;
+        k = std::min( k, n - k );
+        if( k == 0 ) return 1;
+
+        BigInt numerator   = product( consecutive_factors( n - k + 1, n ) );
+        BigInt denominator = factorial( k );
+        return numerator / denominator;
+    }
+
+} // End of namespace vtsu
@@ -0,0 +1,313 @@
+/**************************************************************************
+FILE          : BigIntTest.cpp
+PROGRAMMER    : Peter Chapin
+
+(C) Copyright 2006 by Peter C. Chapin
+
+This file contains a regression test for the BigInt algorithms. The fast algorithms only take
+over at sizes that are too large to test thoroughly, so the test lowers the thresholds in
+BigIntTuning until every algorithm is used on small operands. It then checks the results
+against the simplest methods: schoolbook multiplication, Algorithm D division, and the quadratic
+decimal conversion. Those are selected by setting every threshold to its largest value.
+
+Each tuning configuration below makes one tier of the multiplication engine the one used at the
+top level for most of the test operands. Division, radix conversion, and modular reduction use
+their fast methods in all of them, so they are also tested on top of every multiplication
+method. The program prints each failure and exits with a failure status if there are any. It is
+run by ctest.
+**************************************************************************/
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "BigInt.hpp"
+
+using vtsu::BigInt;
+using vtsu::BigIntTuning;
+
+namespace {
+
+    const std::size_t never = static_cast<std::size_t>( -1 );
+
+    struct Tuning {
+        const char *name;
+        std::size_t karatsuba;
+        std::size_t toom3;
+        std::size_t ntt;
+        std::size_t burnikel_ziegler;
+        std::size_t radix;
+        std::size_t montgomery;
+        std::size_t parallel;
+    };
+
+    // The reference configuration uses only the simple methods.
+    const Tuning reference = { "reference", never, never, never, never, never, never, never };
+
+    const Tuning configurations[] = {
+        { "karatsuba", 4, never, never, 8, 4, 4, never },
+        { "toom3",     4, 12,    never, 8, 4, 4, never },
+        { "ntt",       4, 12,    48,    8, 4, 4, never },
+        { "parallel",  4, 12,    48,    8, 4, 4, 32    },
+    };
+
+    void apply( const Tuning &tuning )
+    {
+        BigIntTuning::karatsuba_threshold        = tuning.karatsuba;
+        BigIntTuning::toom3_threshold            = tuning.toom3;
+        BigIntTuning::ntt_threshold              = tuning.ntt;
+        BigIntTuning::burnikel_ziegler_threshold = tuning.burnikel_ziegler;
+        BigIntTuning::radix_threshold            = tuning.radix;
+        BigIntTuning::montgomery_threshold       = tuning.montgomery;
+        BigIntTuning::parallel_threshold         = tuning.parallel;
+    }
+
+    std::mt19937 generator( 20061017 );
+    int failures = 0;
+
+    void check( bool condition, const char *configuration, const char *what, std::size_t test )
+    {
+        if( !condition ) {
+            ++failures;
+            std::cout << "FAILED: " << what << " (" << configuration << ", case " << test << ")"
+                      << std::endl;
+        }
+    }
+
+    // Returns a value of exactly limb_count limbs. Random limbs are the usual case, but limbs
+    // of all ones and powers of the limb base exercise the carries and the edge cases of the
+    // division and conversion algorithms.
+    //
+    BigInt make_value( std::size_t limb_count, bool negative )
+    {
+        static const char hex_digits[] = "0123456789abcdef";
+        std::string text = negative ? "-" : "";
+        const unsigned pattern = generator( ) % 8;
+        for( std::size_t i = 0; i < limb_count; ++i ) {
+            std::uint32_t limb = static_cast<std::uint32_t>( generator( ) );
+            if( pattern == 0 ) limb = 0xFFFFFFFFU;
+            else if( pattern == 1 ) limb = ( i == 0 ) ? 1 : 0;
+            if( i == 0 && limb == 0 ) limb = 1;
+            for( int shift = 28; shift >= 0; shift -= 4 ) {
+                text += hex_digits[( limb >> shift ) & 0xF];
+            }
+        }
+        return BigInt::from_string( text, 16 );
+    }
+
+    std::size_t random_size( std::size_t largest )
+    {
+        return 1 + generator( ) % largest;
+    }
+
+    struct Case {
+        BigInt a, b;            // Operands of any sizes and signs.
+        BigInt dividend, divisor;
+        BigInt product;         // a * b by the reference methods.
+        BigInt quotient, remainder;
+        std::string decimal;    // The product in base 10 by the reference methods.
+    };
+
+    std::vector<Case> make_cases( )
+    {
+        std::vector<Case> cases;
+        for( std::size_t i = 0; i < 120; ++i ) {
+            Case c;
+            const std::size_t largest = ( i < 80 ) ? 64 : 400;
+            const std::size_t an = random_size( largest );
+
+            // Balanced and unbalanced operands.
+            const std::size_t bn =
+                ( i % 3 == 0 ) ? random_size( an ) : an - generator( ) % ( an / 8 + 1 );
+            c.a = make_value( an, generator( ) % 4 == 0 );
+            c.b = make_value( bn, generator( ) % 4 == 0 );
+
+            // Burnikel-Ziegler is at its best with a dividend twice the size of the divisor.
+            const std::size_t dn = random_size( largest );
+            c.divisor  = make_value( dn, generator( ) % 4 == 0 );
+            c.dividend = make_value( dn + random_size( dn + 2 ), generator( ) % 4 == 0 );
+
+            // Remainders just below the divisor push the quotient estimates to their limits.
+            if( i % 5 == 0 ) {
+                const BigInt zero( 0 );
+                BigInt magnitude = ( c.divisor < zero ) ? zero - c.divisor : c.divisor;
+                c.dividend = c.divisor * make_value( dn, false ) + ( magnitude - BigInt( 1 ) );
+            }
+            cases.push_back( c );
+        }
+
+        apply( reference );
+        for( Case &c : cases ) {
+            c.product = c.a * c.b;
+            std::pair<BigInt, BigInt> qr = vtsu::divmod( c.dividend, c.divisor );
+            c.quotient  = qr.first;
+            c.remainder = qr.second;
+            c.decimal   = c.product.to_string( );
+        }
+        return cases;
+    }
+
+    // Checks the reference results themselves. Division and multiplication must agree, and
+    // the remainder must be smaller than the divisor with the sign of the dividend.
+    //
+    void check_reference( const std::vector<Case> &cases )
+    {
+        apply( reference );
+        for( std::size_t i = 0; i < cases.size( ); ++i ) {
+            const Case &c = cases[i];
+            BigInt back = c.quotient * c.divisor + c.remainder;
+            check( back == c.dividend, "reference", "quotient * divisor + remainder", i );
+
+            BigInt zero( 0 );
+            BigInt magnitude = ( c.divisor < zero ) ? zero - c.divisor : c.divisor;
+            BigInt r_magnitude = ( c.remainder < zero ) ? zero - c.remainder : c.remainder;
+            check( r_magnitude < magnitude, "reference", "remainder size", i );
+            check( c.remainder == zero || ( c.remainder < zero ) == ( c.dividend < zero ),
+                   "reference", "remainder sign", i );
+        }
+    }
+
+    void check_multiply( const Tuning &tuning, const std::vector<Case> &cases )
+    {
+        apply( tuning );
+        for( std::size_t i = 0; i < cases.size( ); ++i ) {
+            const Case &c = cases[i];
+            check( c.a * c.b == c.product, tuning.name, "multiply", i );
+
+            BigInt square = c.a * c.a;
+            apply( reference );
+            BigInt expected_square = c.a * c.a;
+            apply( tuning );
+            check( square == expected_square, tuning.name, "square", i );
+        }
+    }
+
+    // Division, radix conversion, and the modular arithmetic are built on multiplication.
+    void check_division_and_radix( const Tuning &tuning, const std::vector<Case> &cases )
+    {
+        apply( tuning );
+        for( std::size_t i = 0; i < cases.size( ); ++i ) {
+            const Case &c = cases[i];
+            const BigInt &product = c.product;
+
+            std::pair<BigInt, BigInt> qr = vtsu::divmod( c.dividend, c.divisor );
+            check( qr.first == c.quotient, tuning.name, "quotient", i );
+            check( qr.second == c.remainder, tuning.name, "remainder", i );
+
+            const std::string decimal = product.to_string( );
+            check( decimal == c.decimal, tuning.name, "to_string", i );
+            check( BigInt::from_string( c.decimal ) == c.product, tuning.name, "from_string", i );
+            for( int base : { 2, 8, 16 } ) {
+                check( BigInt::from_string( product.to_string( base ), base ) == product,
+                       tuning.name, "power of two base round trip", i );
+            }
+
+            std::stringstream stream;
+            BigInt read_back;
+            stream << std::hex << std::uppercase << product;
+            stream >> read_back;
+            check( read_back == product, tuning.name, "stream round trip", i );
+        }
+    }
+
+    // Computes base^exponent mod modulus the slow way, with a full division at every step.
+    BigInt reference_pow_mod( BigInt base, BigInt exponent, const BigInt &modulus )
+    {
+        const BigInt zero( 0 ), two( 2 );
+        BigInt result( 1 );
+        base %= modulus;
+        while( zero < exponent ) {
+            std::pair<BigInt, BigInt> halves = vtsu::divmod( exponent, two );
+            if( !( halves.second == zero ) ) {
+                result *= base;
+                result %= modulus;
+            }
+            base *= base;
+            base %= modulus;
+            exponent = halves.first;
+        }
+        return result;
+    }
+
+    // Both kinds of modulus: odd ones use Montgomery reduction and even ones Barrett reduction.
+    void check_modular( const Tuning &tuning )
+    {
+        for( std::size_t i = 0; i < 24; ++i ) {
+            const std::size_t mn = random_size( ( i < 16 ) ? 12 : 48 );
+            BigInt modulus = make_value( mn, false );
+            if( i % 2 == 0 ) modulus = modulus * BigInt( 2 ) + BigInt( 1 );
+            else             modulus = modulus * BigInt( 2 );
+            BigInt base     = make_value( random_size( 2 * mn ), false );
+            BigInt exponent = make_value( random_size( 3 ), false );
+
+            apply( reference );
+            BigInt expected = reference_pow_mod( base, exponent, modulus );
+            apply( tuning );
+            check( vtsu::pow_mod( base, exponent, modulus ) == expected,
+                   tuning.name, "pow_mod", i );
+
+            apply( reference );
+            BigInt expected_product = ( base * exponent ) % modulus;
+            apply( tuning );
+            vtsu::BigIntModulus fixed( modulus );
+            check( fixed.multiply( base, exponent ) == expected_product, tuning.name,
+                   "BigIntModulus::multiply", i );
+        }
+    }
+
+    BigInt reference_factorial( long n )
+    {
+        BigInt result( 1 );
+        for( long k = 2; k <= n; ++k ) result *= BigInt( k );
+        return result;
+    }
+
+    // The product tree used by factorial and binomial.
+    void check_products( const Tuning &tuning )
+    {
+        apply( reference );
+        BigInt expected = reference_factorial( 1500 );
+        BigInt expected_binomial =
+            vtsu::divmod( expected, reference_factorial( 700 ) * reference_factorial( 800 ) ).first;
+
+        apply( tuning );
+        check( vtsu::factorial( 1500 ) == expected, tuning.name, "factorial", 0 );
+        check( vtsu::binomial( 1500, 700 ) == expected_binomial, tuning.name, "binomial", 0 );
+    }
+
+}
+
+int main( )
+{
+    BigIntTuning::thread_count = 4;
+
+    // A wrong product can keep the correction loops of the fast division methods from ever
+    // ending, so the multiplication methods are checked first and nothing that depends on them
+    // is tried if they fail.
+    //
+    std::vector<Case> cases = make_cases( );
+    check_reference( cases );
+    for( const Tuning &tuning : configurations ) {
+        check_multiply( tuning, cases );
+    }
+    if( failures != 0 ) {
+        std::cout << failures << " checks failed\n";
+        return EXIT_FAILURE;
+    }
+
+    for( const Tuning &tuning : configurations ) {
+        check_division_and_radix( tuning, cases );
+        check_modular( tuning );
+        check_products( tuning );
+    }
+
+    if( failures != 0 ) {
+        std::cout << failures << " checks failed\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "All checks passed\n";
+    return EXIT_SUCCESS;
+}
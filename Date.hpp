@@ -1,12 +1,12 @@
 /****************************************************************************
 FILE          : Date.hpp
-LAST REVISED  : 2023-07-20
+LAST REVISED  : 2026-10-17
 SUBJECT       : Interface to a simple date handling class
 PROGRAMMER    : (C) Copyright 2023 by Peter Chapin
 
 This file defines a simple Date abstract data type. Date objects will handle dates between Jan
-1, 1800 and Dec 31, 2099. Any attempt to set a date object outside that range, either directly
-or by way of a computation, will have undefined effects.
+1, 1800 and Dec 31, 2099. Attempts to set a date object outside that range, either directly or
+by way of a computation, are forced back into the range.
 
 The interface to date objects uses 1-based numbering: January is month 1, February is month 2,
 and so on. Furthermore, the first day of the month is day 1. Years must be full, four digit
@@ -17,50 +17,104 @@ demonstration of the basics of classes and information hiding.
 #ifndef DATE_HPP
 #define DATE_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <iosfwd>
+#include <iterator>
+#include <vector>
 
 namespace vtsu {
 
+    // The calendar tables used by Date. They are computed by the compiler from the lengths of
+    // the months; see make_month_table below.
+    //
+    struct MonthTable {
+        int length[2][12];  // Days in each month of common (row 0) and leap (row 1) years.
+        int before[2][13];  // Days in the year before each month. before[leap][12] is the
+                            // length of the year.
+    };
+
     class Date {
 
+        // Bulk parsing and batch operations (see below).
+        friend const char *parse_dates( const char *first, const char *last, std::vector<Date> &dates );
+        friend void advance_all( Date *dates, std::size_t count, long delta );
+
     public:
 
+        // The supported range, as day numbers (see day_number below). These are Jan 1, 1800
+        // and Dec 31, 2099. The values are checked when this header is compiled.
+        //
+        static constexpr long first_day = -62091;
+        static constexpr long last_day  =  47481;
+
         // Default constructor initializes the date to Jan 1, 1970.
-        Date( ) { D = 1; M = 1; Y = 1970; }
+        constexpr Date( ) : serial( 0 ) { }
 
         // Allows initializing dates to some other value. Note that the year should be a full
-        // four digits. This function also performs some sanity checks. It will force the D, M,
-        // and Y values into range.
+        // four digits. This function also performs some sanity checks. It will force the day,
+        // month, and year values into range.
         //
-        Date( int day, int month, int year )
+        constexpr Date( int day, int month, int year ) : serial( 0 )
             { set( day, month, year ); }
 
         // Allows setting a date after it's been constructed. Semantics are just like those of
         // the constructor above.
         //
-        void set( int day, int month, int year );
+        constexpr void set( int day, int month, int year );
 
-        // Access functions.
-        int day( )   const { return D; }
-        int month( ) const { return M; }
-        int year( )  const { return Y; }
+        // Access functions. Each of these has to convert the day number back to the calendar,
+        // so use get to fetch all three parts at once.
+        //
+        constexpr int  day( )   const;
+        constexpr int  month( ) const;
+        constexpr int  year( )  const;
+        constexpr void get( int &day, int &month, int &year ) const;
+
+        // The number of days from Jan 1, 1970 to this date. It is negative for earlier dates.
+        constexpr long day_number( ) const { return serial; }
+
+        // Returns the date with the given day number, forced into the supported range.
+        static constexpr Date from_day_number( long days );
+
+        // The day of the week, with 0 for Sunday through 6 for Saturday (as in std::tm).
+        constexpr int day_of_week( ) const;
+
+        // The day of the year, with 1 for Jan 1.
+        constexpr int day_of_year( ) const;
 
         // Operations.
 
         // Advance the date by given number of days. If delta is negative this function will
-        // back the date up.
+        // back the date up. This takes the same time no matter how large delta is.
         //
-        void advance( long delta = 1 );
+        constexpr void advance( long delta = 1 );
+
+        // Advance the date by whole months or years (backward if negative). The day of the
+        // month stays the same if the new month has that day and otherwise becomes the last
+        // day of the new month, so Jan 31 plus one month is the end of February. The result is
+        // forced into the supported range.
+        //
+        constexpr void add_months( long months );
+        constexpr void add_years( long years );
+
+        // Calendar rules. The function is_valid returns true if the day, month, and year name
+        // a real date in the supported range; the constructors would leave such a date alone.
+        //
+        static constexpr bool is_leap( int year );
+        static constexpr int  month_length( int month, int year );
+        static constexpr bool is_valid( int day, int month, int year );
 
     private:
 
-        // The "obvious" implementation.
-        int D, M, Y;
+        // The date is stored as a count of days from Jan 1, 1970. This makes arithmetic on
+        // dates simple and fast. The calendar is only needed when a date is created or taken
+        // apart. The supported range needs 17 bits, so a Date is a single 32 bit integer.
+        //
+        std::int32_t serial;
 
-        bool is_leap( ) const;       // True if the current year is a leap year.
-        int  month_length( ) const;  // Number of days in the current month.
-        void next( );                // Advances the date by one day.
-        void previous( );            // Backs up the date by one day.
+        static constexpr long days_from_civil( int day, int month, int year );
+        static constexpr void civil_from_days( long days, int &day, int &month, int &year );
 
     };
 
@@ -68,32 +122,596 @@ namespace vtsu {
     // Non-member Functions
     //
 
-    bool operator==( const date &left, const date &right );
-    bool operator< ( const date &left, const date &right );
+    // Dates compare by their day numbers. These functions don't need to be friends because
+    // they do not attempt to access the private section of Date. They will continue to work
+    // even if the implementation of Date is changed.
+    //
+    constexpr bool operator==( const Date &left, const Date &right )
+        { return left.day_number( ) == right.day_number( ); }
+
+    constexpr bool operator< ( const Date &left, const Date &right )
+        { return left.day_number( ) < right.day_number( ); }
 
     // The other relationals can be implemented in terms of the two above.
 
-    inline bool operator!=( const date &left, const date &right )
+    constexpr bool operator!=( const Date &left, const Date &right )
         { return !( left == right ); }
 
-    inline bool operator<=( const date &left, const date &right )
+    constexpr bool operator<=( const Date &left, const Date &right )
         { return left < right || left == right; }
 
-    inline bool operator>( const date &left, const date &right )
+    constexpr bool operator>( const Date &left, const Date &right )
         { return !( left <= right ); }
 
-    inline bool operator>=( const date &left, const date &right )
+    constexpr bool operator>=( const Date &left, const Date &right )
         { return !( left < right ); }
 
 
-    // This function figures out how many days difference there is between two dates.
+    // This function figures out how many days difference there is between two dates. It is
+    // negative if left is earlier.
     //
-    long operator-( const date &left, const date &right );
+    constexpr long operator-( const Date &left, const Date &right )
+        { return left.day_number( ) - right.day_number( ); }
 
     // I suppose we'll want to do I/O operations too.
-    std::ostream &operator<<( std::ostream &output, const date &right a);
-    std::istream &operator>>( std::istream &input, date &right );
-    
+    std::ostream &operator<<( std::ostream &output, const Date &right );
+    std::istream &operator>>( std::istream &input, Date &right );
+
+    // The fixed text formats a date can be written in. All of them have four digit years and
+    // two digit months and days.
+    //
+    enum class DateFormat {
+        iso,       // yyyy-mm-dd
+        compact,   // yyyymmdd
+        us,        // mm/dd/yyyy
+        european   // dd.mm.yyyy
+    };
+
+    // The most characters any of the formats takes.
+    const std::size_t max_date_text = 10;
+
+    // Writes the date into buffer, which must have room for max_date_text characters, and
+    // returns a pointer just past the last character written. No null character is added. This
+    // doesn't use streams or locales and never allocates memory.
+    //
+    char *format_date( char *buffer, const Date &date, DateFormat format = DateFormat::iso );
+
+    // Writes count dates into buffer, each followed by separator. The buffer must have room for
+    // count * (max_date_text + 1) characters. Returns a pointer just past the last character
+    // written.
+    //
+    char *format_dates( char *buffer, const Date *dates, std::size_t count,
+                        char separator = '\n', DateFormat format = DateFormat::iso );
+
+    //
+    // DateRange
+    //
+    // The dates from first up to, but not including, last as a random access sequence. The
+    // range and its iterators hold day numbers, so moving any distance, taking the distance
+    // between iterators, and indexing all take constant time. No Date objects are stored in
+    // the range, so each iterator keeps the Date it refers to and dereferencing returns a
+    // reference to that. The reference is good until the iterator is moved or destroyed, so
+    // don't hold on to it (std::reverse_iterator does, so use indexes to go backward).
+    //
+    class DateRange {
+    public:
+        class iterator {
+        public:
+            typedef std::random_access_iterator_tag iterator_category;
+            typedef Date        value_type;
+            typedef long        difference_type;
+            typedef const Date *pointer;
+            typedef const Date &reference;
+
+            constexpr iterator( ) : day( 0 ), current( ) { }
+            constexpr explicit iterator( long day ) :
+                day( day ), current( Date::from_day_number( day ) ) { }
+
+            constexpr const Date &operator*( ) const { return current; }
+            constexpr const Date *operator->( ) const { return &current; }
+            constexpr Date operator[]( long n ) const { return Date::from_day_number( day + n ); }
+
+            constexpr iterator &operator++( )       { return move( 1 ); }
+            constexpr iterator &operator--( )       { return move( -1 ); }
+            constexpr iterator  operator++( int )   { iterator old = *this; move( 1 ); return old; }
+            constexpr iterator  operator--( int )   { iterator old = *this; move( -1 ); return old; }
+            constexpr iterator &operator+=( long n ) { return move( n ); }
+            constexpr iterator &operator-=( long n ) { return move( -n ); }
+
+            friend constexpr iterator operator+( iterator it, long n ) { return it += n; }
+            friend constexpr iterator operator+( long n, iterator it ) { return it += n; }
+            friend constexpr iterator operator-( iterator it, long n ) { return it -= n; }
+            friend constexpr long operator-( iterator left, iterator right )
+                { return left.day - right.day; }
+
+            friend constexpr bool operator==( iterator left, iterator right ) { return left.day == right.day; }
+            friend constexpr bool operator!=( iterator left, iterator right ) { return left.day != right.day; }
+            friend constexpr bool operator< ( iterator left, iterator right ) { return left.day <  right.day; }
+            friend constexpr bool operator> ( iterator left, iterator right ) { return left.day >  right.day; }
+            friend constexpr bool operator<=( iterator left, iterator right ) { return left.day <= right.day; }
+            friend constexpr bool operator>=( iterator left, iterator right ) { return left.day >= right.day; }
+
+        private:
+            long day;       // May be one past the end of the supported range (or before it).
+            Date current;   // The date with day number day, forced into the supported range.
+
+            constexpr iterator &move( long n )
+            {
+                day += n;
+                current = Date::from_day_number( day );
+                return *this;
+            }
+        };
+
+        // The dates in [from, to), or count dates starting at from. A range that would run past
+        // the end of the supported range stops there.
+        //
+        constexpr DateRange( const Date &from, const Date &to ) :
+            first( from.day_number( ) ), last( to.day_number( ) )
+            { if( last < first ) last = first; }
+
+        constexpr DateRange( const Date &from, long count ) :
+            first( from.day_number( ) ), last( from.day_number( ) )
+        {
+            const long room = Date::last_day + 1 - first;
+            last += ( count < 0 ) ? 0 : ( count > room ? room : count );
+        }
+
+        constexpr iterator begin( ) const { return iterator( first ); }
+        constexpr iterator end( )   const { return iterator( last ); }
+        constexpr long     size( )  const { return last - first; }
+        constexpr bool     empty( ) const { return last == first; }
+        constexpr Date operator[]( long n ) const { return Date::from_day_number( first + n ); }
+
+    private:
+        long first;
+        long last;
+    };
+
+
+    //
+    // BusinessCalendar
+    //
+    // Knows which days are business days: every day except the weekend days and the given
+    // holidays. The answers for the whole supported range are computed when the calendar is
+    // created, as one bit per day with a running count of business days for every 64 days. With
+    // those, counting the business days between two dates or stepping over any number of
+    // business days takes no longer than finding one bit (see DateBusiness.cpp).
+    //
+    class BusinessCalendar {
+    public:
+        // Weekend days as a bit mask indexed by Date::day_of_week (bit 0 is Sunday).
+        static const unsigned saturday_and_sunday = ( 1U << 0 ) | ( 1U << 6 );
+
+        explicit BusinessCalendar(
+            const std::vector<Date> &holidays = std::vector<Date>( ),
+            unsigned weekend = saturday_and_sunday );
+
+        bool is_business_day( const Date &date ) const;
+
+        // Returns the number of business days in [first, last). It is negative if last is
+        // before first.
+        //
+        long count( const Date &first, const Date &last ) const;
+
+        // Returns the date n business days after date (before it if n is negative). The result
+        // is always a business day unless n is zero, in which case date is returned. Results
+        // that would be outside the supported range are forced to its ends.
+        //
+        Date advance( const Date &date, long n ) const;
+
+    private:
+        std::vector<std::uint64_t> bits;    // Bit i is set if Date::first_day + i is a business day.
+        std::vector<long>          before;  // The number of business days before each word of bits.
+
+        long rank( long day ) const;        // Business days from Date::first_day up to day.
+        long select( long index ) const;    // The day number of the business day with the given rank.
+    };
+
+
+    //
+    // DateColumn
+    //
+    // A column of dates stored as a contiguous array of 32 bit day numbers, for tables that
+    // keep each field in an array of its own. Scans over the column read nothing but the day
+    // numbers and compare them as plain integers, which the compiler can vectorize. Rows are
+    // numbered from zero in the order they were added (until the column is sorted).
+    //
+    class DateColumn {
+    public:
+        DateColumn( ) = default;
+        DateColumn( const Date *dates, std::size_t count );
+
+        std::size_t size( ) const  { return days.size( ); }
+        bool        empty( ) const { return days.empty( ); }
+        void        reserve( std::size_t count ) { days.reserve( count ); }
+        void        clear( ) { days.clear( ); }
+
+        void push_back( const Date &date )
+            { days.push_back( static_cast<std::int32_t>( date.day_number( ) ) ); }
+
+        Date operator[]( std::size_t row ) const { return Date::from_day_number( days[row] ); }
+
+        // The day numbers of the rows, as returned by Date::day_number.
+        const std::int32_t *day_numbers( ) const { return days.data( ); }
+
+        // The earliest and latest dates in the column, which must not be empty.
+        Date min( ) const;
+        Date max( ) const;
+
+        // Returns the number of rows with dates in [first, last).
+        std::size_t count( const Date &first, const Date &last ) const;
+
+        // Returns the rows with dates in [first, last), either as a new column or as the row
+        // numbers (to select from the other columns of a table). Both keep the rows in order.
+        //
+        DateColumn               select( const Date &first, const Date &last ) const;
+        std::vector<std::size_t> rows( const Date &first, const Date &last ) const;
+
+        // Puts the rows in order by date. This uses the same linear time sort as sort_dates.
+        void sort( );
+
+    private:
+        std::vector<std::int32_t> days;
+    };
+
+
+    // Sorting. Dates have fewer than 2^17 possible values, so they can be sorted in linear
+    // time. The function sort_dates counts how many times each day occurs and writes the dates
+    // back in order; it uses std::sort for arrays too small to pay for the counts. The
+    // function sort_order returns the row numbers of the dates in date order, keeping rows
+    // with equal dates in their original order, to sort records that have a date. It is a
+    // radix sort with two passes of 9 and 8 bits.
+    //
+    void sort_dates( Date *dates, std::size_t count );
+    std::vector<std::size_t> sort_order( const Date *dates, std::size_t count );
+
+    // The periods dates can be grouped by. The periods in the supported range are numbered
+    // from 0 for the one that holds Jan 1, 1800.
+    //
+    enum class DatePeriod { day, month, year };
+
+    constexpr long period_count( DatePeriod period );
+    constexpr long period_index( const Date &date, DatePeriod period );
+    constexpr Date period_start( long index, DatePeriod period );
+
+    // One group found by group_dates. The rows of the group are order[first] through
+    // order[first + count - 1].
+    //
+    struct DateGroup {
+        Date        start;  // The first day of the period.
+        std::size_t first;
+        std::size_t count;
+    };
+
+    // Groups the dates by period. Returns the groups that have at least one date, in date
+    // order, and fills order with the row numbers of the dates arranged by group. The rows in
+    // each group stay in their original order. The dates are put into buckets by a counting
+    // sort, so the time is linear in the number of dates.
+    //
+    std::vector<DateGroup> group_dates(
+        const Date *dates, std::size_t count, DatePeriod period, std::vector<std::size_t> &order );
+
+    // Adds up values by period, without any sorting. Returns a vector with one sum for every
+    // period in the supported range, indexed as by period_index.
+    //
+    template<typename T>
+    std::vector<T> sum_by_period( const Date *dates, const T *values, std::size_t count, DatePeriod period )
+    {
+        std::vector<T> sums( static_cast<std::size_t>( period_count( period ) ), T( ) );
+        for( std::size_t i = 0; i < count; ++i ) {
+            sums[static_cast<std::size_t>( period_index( dates[i], period ) )] += values[i];
+        }
+        return sums;
+    }
+
+    // Batch operations on arrays of dates. Each does the same thing as calling the
+    // corresponding member function or operator for every date, but the loops are written so
+    // that the compiler can vectorize them, working on several dates at once. The calendar
+    // conversions use 32 bit unsigned arithmetic, which is enough for the supported range.
+    //
+    // advance_all       dates[i].advance( delta )
+    // difference_all    differences[i] = left[i] - right[i]
+    // day_of_week_all   days[i] = dates[i].day_of_week( )
+    // day_of_year_all   days[i] = dates[i].day_of_year( )
+    // split_all         dates[i].get( days[i], months[i], years[i] )
+    //
+    void advance_all( Date *dates, std::size_t count, long delta );
+    void difference_all( long *differences, const Date *left, const Date *right, std::size_t count );
+    void day_of_week_all( int *days, const Date *dates, std::size_t count );
+    void day_of_year_all( int *days, const Date *dates, std::size_t count );
+    void split_all( int *days, int *months, int *years, const Date *dates, std::size_t count );
+
+    // Reads dates in the form yyyy-mm-dd from the text in [first, last) and appends them to
+    // dates. The dates can be separated by any characters other than digits, such as newlines
+    // or commas. Years outside the supported range are forced into it. Parsing stops at the
+    // first date that isn't of that form or has an impossible month or day. The function
+    // returns a pointer to that date or last if all the text was read. This is much faster
+    // than reading dates with operator>>.
+    //
+    const char *parse_dates( const char *first, const char *last, std::vector<Date> &dates );
+
+
+    //-----------------------------------
+    //         Inline Functions
+    //-----------------------------------
+    // Everything needed to create and take apart dates is constexpr, so dates with constant
+    // values are worked out entirely by the compiler.
+
+    //
+    // make_month_table( )
+    //
+    // Builds the month tables from the lengths of the months in a common year.
+    //
+    constexpr MonthTable make_month_table( )
+    {
+        const int common[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+        MonthTable table = { };
+        for( int leap = 0; leap < 2; ++leap ) {
+            for( int m = 0; m < 12; ++m ) {
+                table.length[leap][m]     = common[m] + ( m == 1 ? leap : 0 );
+                table.before[leap][m + 1] = table.before[leap][m] + table.length[leap][m];
+            }
+        }
+        return table;
+    }
+
+    inline constexpr MonthTable month_table = make_month_table( );
+
+
+    constexpr bool Date::is_leap( int year )
+    {
+        return ( year % 4 == 0 && year % 100 != 0 ) || year % 400 == 0;
+    }
+
+
+    constexpr int Date::month_length( int month, int year )
+    {
+        return month_table.length[is_leap( year )][month - 1];
+    }
+
+
+    constexpr bool Date::is_valid( int day, int month, int year )
+    {
+        return year >= 1800 && year <= 2099 && month >= 1 && month <= 12 &&
+               day >= 1 && day <= month_length( month, year );
+    }
+
+
+    //
+    // Date::days_from_civil( int, int, int )
+    //
+    // Returns the day number of the given (valid) date using the algorithm in Howard Hinnant's
+    // paper "chrono-Compatible Low-Level Date Algorithms." The year is taken to start on March
+    // 1 so that the leap day falls at the end, and the calendar is divided into 400 year "eras,"
+    // which repeat exactly. With March as month 0, the number of days before the start of
+    // month m is (153m + 2)/5; the months from March to January follow the pattern 31, 30, 31,
+    // 30, 31 twice over, which that formula reproduces exactly.
+    //
+    constexpr long Date::days_from_civil( int day, int month, int year )
+    {
+        const long y    = year - ( month <= 2 );
+        const long era  = ( y >= 0 ? y : y - 399 ) / 400;
+        const long yoe  = y - era * 400;                                   // [0, 399]
+        const long doy  = ( 153 * ( month > 2 ? month - 3 : month + 9 ) + 2 ) / 5 + day - 1;
+        const long doe  = yoe * 365 + yoe / 4 - yoe / 100 + doy;           // [0, 146096]
+        return era * 146097 + doe - 719468;
+    }
+
+
+    //
+    // Date::civil_from_days( long, int &, int &, int & )
+    //
+    // This is the inverse of days_from_civil. The year of the era is found by removing the
+    // leap days (one every 1460 days, except one every 36524, except one every 146096) and
+    // dividing by 365.
+    //
+    constexpr void Date::civil_from_days( long days, int &day, int &month, int &year )
+    {
+        const long z   = days + 719468;
+        const long era = ( z >= 0 ? z : z - 146096 ) / 146097;
+        const long doe = z - era * 146097;                                           // [0, 146096]
+        const long yoe = ( doe - doe / 1460 + doe / 36524 - doe / 146096 ) / 365;    // [0, 399]
+        const long doy = doe - ( 365 * yoe + yoe / 4 - yoe / 100 );                  // [0, 365]
+        const long mp  = ( 5 * doy + 2 ) / 153;                                      // [0, 11]
+
+        day   = static_cast<int>( doy - ( 153 * mp + 2 ) / 5 + 1 );
+        month = static_cast<int>( mp < 10 ? mp + 3 : mp - 9 );
+        year  = static_cast<int>( yoe + era * 400 + ( month <= 2 ) );
+    }
+
+
+    //
+    // Date::set( int, int, int )
+    //
+    // This function initializes the Date to values given to us by the client. We don't trust
+    // the client to give us sensible values.
+    //
+    constexpr void Date::set( int day, int month, int year )
+    {
+        // If we get a year < 100 it probably means the client is giving us just a two digit
+        // year. We will take any two digit year below 50 to mean 2000 to 2050. This hack will
+        // help make this date class well behaved even when two digit years are used.
+        //
+        if( year < 100 ) {
+            if( year < 50 ) year += 2000;
+            else year += 1900;
+        }
+
+        // Year check. If the client gives us a year that's really far off, it's probably an
+        // error. We'll deal with that by just artificially restricting the year.
+
+        if( year < 1800 ) year = 1800;
+        if( year > 2099 ) year = 2099;
+
+        // Month Check. It would be cooler to advance the Date appropriately so that, for
+        // example, the 13th month would end up being the first month of the next year. However,
+        // I don't see why we should make excuses for the client's errors. :)
+
+        if( month <  1 ) month =  1;
+        if( month > 12 ) month = 12;
+
+        // Day Check.
+
+        if( day < 1 ) day = 1;
+        if( day > month_length( month, year ) ) day = month_length( month, year );
+
+        serial = static_cast<int>( days_from_civil( day, month, year ) );
+    }
+
+
+    constexpr void Date::get( int &day, int &month, int &year ) const
+    {
+        civil_from_days( serial, day, month, year );
+    }
+
+
+    constexpr int Date::day( ) const
+    {
+        int d = 0, m = 0, y = 0;
+        get( d, m, y );
+        return d;
+    }
+
+
+    constexpr int Date::month( ) const
+    {
+        int d = 0, m = 0, y = 0;
+        get( d, m, y );
+        return m;
+    }
+
+
+    constexpr int Date::year( ) const
+    {
+        int d = 0, m = 0, y = 0;
+        get( d, m, y );
+        return y;
+    }
+
+
+    //
+    // Date::day_of_week( ) const
+    //
+    // Jan 1, 1970 was a Thursday (day 4). Earlier dates have negative day numbers, so a
+    // multiple of 7 larger than -first_day is added to keep the remainder positive.
+    //
+    constexpr int Date::day_of_week( ) const
+    {
+        return static_cast<int>( ( serial + 4 + 7 * ( -first_day / 7 + 1 ) ) % 7 );
+    }
+
+
+    constexpr int Date::day_of_year( ) const
+    {
+        int d = 0, m = 0, y = 0;
+        get( d, m, y );
+        return month_table.before[is_leap( y )][m - 1] + d;
+    }
+
+
+    //
+    // Date::advance( long )
+    //
+    // This function advances (or backs up) a Date by the specified number of days. Dates
+    // outside the supported range are forced to the nearest end of it.
+    //
+    constexpr void Date::advance( long delta )
+    {
+        long result = serial;
+
+        // Check against the limits before adding so that a huge delta can't overflow.
+        if( delta > last_day - result ) result = last_day;
+        else if( delta < first_day - result ) result = first_day;
+        else result += delta;
+
+        serial = static_cast<int>( result );
+    }
+
+
+    constexpr Date Date::from_day_number( long days )
+    {
+        Date result;
+        result.advance( days );
+        return result;
+    }
+
+
+    //
+    // Date::add_months( long )
+    //
+    // Months are counted from year 0 so that adding months is just addition. The count is
+    // checked against the limits before adding so that a huge number of months can't overflow.
+    //
+    constexpr void Date::add_months( long months )
+    {
+        int d = 0, m = 0, y = 0;
+        get( d, m, y );
+
+        const long first_month = 1800L * 12;
+        const long last_month  = 2099L * 12 + 11;
+        long index = y * 12L + ( m - 1 );
+        if( months > last_month - index ) index = last_month;
+        else if( months < first_month - index ) index = first_month;
+        else index += months;
+
+        y = static_cast<int>( index / 12 );
+        m = static_cast<int>( index % 12 ) + 1;
+        if( d > month_length( m, y ) ) d = month_length( m, y );
+        serial = static_cast<int>( days_from_civil( d, m, y ) );
+    }
+
+
+    constexpr void Date::add_years( long years )
+    {
+        // Any change of more than the width of the range is the same as one of exactly that.
+        const long limit = 2099 - 1800 + 1;
+        add_months( 12 * ( years > limit ? limit : ( years < -limit ? -limit : years ) ) );
+    }
+
+
+    constexpr long period_count( DatePeriod period )
+    {
+        switch( period ) {
+        case DatePeriod::day:   return Date::last_day - Date::first_day + 1;
+        case DatePeriod::month: return ( 2099 - 1800 + 1 ) * 12;
+        case DatePeriod::year:  return 2099 - 1800 + 1;
+        }
+        return 0;
+    }
+
+
+    constexpr long period_index( const Date &date, DatePeriod period )
+    {
+        if( period == DatePeriod::day ) return date.day_number( ) - Date::first_day;
+
+        int day = 0, month = 0, year = 0;
+        date.get( day, month, year );
+        if( period == DatePeriod::month ) return ( year - 1800 ) * 12L + ( month - 1 );
+        return year - 1800;
+    }
+
+
+    constexpr Date period_start( long index, DatePeriod period )
+    {
+        switch( period ) {
+        case DatePeriod::day:   return Date::from_day_number( Date::first_day + index );
+        case DatePeriod::month:
+            return Date( 1, static_cast<int>( index % 12 ) + 1, static_cast<int>( 1800 + index / 12 ) );
+        case DatePeriod::year:  return Date( 1, 1, static_cast<int>( 1800 + index ) );
+        }
+        return Date( );
+    }
+
+
+    // Check the range limits and the day numbering.
+    static_assert( Date( 1, 1, 1800 ).day_number( ) == Date::first_day, "bad first_day" );
+    static_assert( Date( 31, 12, 2099 ).day_number( ) == Date::last_day, "bad last_day" );
+    static_assert( Date( 1, 1, 1970 ).day_of_week( ) == 4, "bad day_of_week" );
+    static_assert( sizeof( Date ) == 4, "Date is not packed" );
+    static_assert( period_index( Date( 31, 12, 2099 ), DatePeriod::month ) == 299 * 12 + 11,
+                   "bad period_index" );
+
 } // namespace vtsu
 
 #endif
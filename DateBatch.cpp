@@ -0,0 +1,130 @@
+/****************************************************************************
+FILE          : DateBatch.cpp
+LAST REVISED  : 2026-10-17
+SUBJECT       : Operations on whole arrays of dates
+PROGRAMMER    : (C) Copyright 2023 by Peter Chapin
+
+These functions apply one Date operation to every element of an array. Each loop body is
+straight line code on 32 bit integers with no calls and no data dependent branches (the
+conditional expressions become selects), so the compiler can vectorize the loops. The calendar
+conversions are the ones in Date.hpp, specialized for the supported range of dates. Every day
+number in that range is more than -719468, so the shifted day number is never negative and the
+arithmetic can be unsigned. That avoids the corrections for negative values and lets the
+divisions by constants become multiplications.
+****************************************************************************/
+
+#include "Date.hpp"
+
+namespace vtsu {
+
+    namespace {
+
+        // The parts of a date computed by civil_from_days in Date.hpp. The "March year" is the
+        // year in which the date's March falls; it is one less than the calendar year in
+        // January and February. The day of the March year counts from 0 on March 1.
+        //
+        struct MarchDate {
+            unsigned year;          // The March year.
+            unsigned year_of_era;   // The March year mod 400.
+            unsigned day_of_year;   // [0, 365]
+            unsigned month_index;   // 0 for March through 11 for February.
+        };
+
+        inline MarchDate to_march_date( int day_number )
+        {
+            const unsigned z   = static_cast<unsigned>( day_number + 719468 );
+            const unsigned era = z / 146097;
+            const unsigned doe = z - era * 146097;
+            const unsigned yoe = ( doe - doe / 1460 + doe / 36524 - doe / 146096 ) / 365;
+
+            MarchDate result;
+            result.year        = yoe + era * 400;
+            result.year_of_era = yoe;
+            result.day_of_year = doe - ( 365 * yoe + yoe / 4 - yoe / 100 );
+            result.month_index = ( 5 * result.day_of_year + 2 ) / 153;
+            return result;
+        }
+
+    }
+
+
+    //
+    // advance_all( Date *, std::size_t, long )
+    //
+    // The delta is first limited to the width of the supported range. Any larger delta moves
+    // every date to the end of the range anyway, and the limit makes the sums fit in an int.
+    //
+    void advance_all( Date *dates, std::size_t count, long delta )
+    {
+        const long width = Date::last_day - Date::first_day;
+        const int  step  = static_cast<int>( delta > width ? width : ( delta < -width ? -width : delta ) );
+        const int  first = static_cast<int>( Date::first_day );
+        const int  last  = static_cast<int>( Date::last_day );
+
+        for( std::size_t i = 0; i < count; ++i ) {
+            int result = dates[i].serial + step;
+            result = ( result < first ) ? first : result;
+            result = ( result > last  ) ? last  : result;
+            dates[i].serial = result;
+        }
+    }
+
+
+    void difference_all( long *differences, const Date *left, const Date *right, std::size_t count )
+    {
+        for( std::size_t i = 0; i < count; ++i ) {
+            differences[i] = left[i].day_number( ) - right[i].day_number( );
+        }
+    }
+
+
+    //
+    // day_of_week_all( int *, const Date *, std::size_t )
+    //
+    // As in Date::day_of_week, a multiple of 7 is added so that the remainder is taken of a
+    // positive number.
+    //
+    void day_of_week_all( int *days, const Date *dates, std::size_t count )
+    {
+        const unsigned offset = static_cast<unsigned>( 4 + 7 * ( -Date::first_day / 7 + 1 ) );
+        for( std::size_t i = 0; i < count; ++i ) {
+            const unsigned shifted = static_cast<unsigned>( dates[i].day_number( ) ) + offset;
+            days[i] = static_cast<int>( shifted % 7 );
+        }
+    }
+
+
+    //
+    // day_of_year_all( int *, const Date *, std::size_t )
+    //
+    // March 1 through December 31 is 306 days, so January and February dates are 306 days
+    // from the start of the March year. Later dates come after the 59 or 60 days of January and
+    // February. The March year is then also the calendar year, and since the March year mod
+    // 400 is known, its leap rule needs no division.
+    //
+    void day_of_year_all( int *days, const Date *dates, std::size_t count )
+    {
+        for( std::size_t i = 0; i < count; ++i ) {
+            const MarchDate date = to_march_date( static_cast<int>( dates[i].day_number( ) ) );
+            const unsigned yoe  = date.year_of_era;
+            const unsigned leap = ( ( yoe % 4 == 0 && yoe % 100 != 0 ) || yoe == 0 ) ? 1 : 0;
+            const unsigned day  = ( date.month_index >= 10 ) ?
+                date.day_of_year - 306 + 1 : date.day_of_year + 59 + leap + 1;
+            days[i] = static_cast<int>( day );
+        }
+    }
+
+
+    void split_all( int *days, int *months, int *years, const Date *dates, std::size_t count )
+    {
+        for( std::size_t i = 0; i < count; ++i ) {
+            const MarchDate date = to_march_date( static_cast<int>( dates[i].day_number( ) ) );
+            const unsigned mp    = date.month_index;
+            const unsigned month = ( mp < 10 ) ? mp + 3 : mp - 9;
+            days[i]   = static_cast<int>( date.day_of_year - ( 153 * mp + 2 ) / 5 + 1 );
+            months[i] = static_cast<int>( month );
+            years[i]  = static_cast<int>( date.year + ( month <= 2 ) );
+        }
+    }
+
+} // namespace vtsu
@@ -0,0 +1,154 @@
+/****************************************************************************
+FILE          : DateBusiness.cpp
+LAST REVISED  : 2026-10-17
+SUBJECT       : Business day arithmetic
+PROGRAMMER    : (C) Copyright 2023 by Peter Chapin
+
+A BusinessCalendar stores one bit for every day in the supported range; the bit is set if the
+day is a business day. Along with the bits it keeps the number of business days that come
+before each 64 bit word. The rank of a day (the number of business days before it) is then
+that count plus the number of set bits in part of one word. Counting the business days between
+two dates is a difference of ranks, and advancing by n business days finds the day whose rank
+is n more than the starting day's: a binary search over the counts followed by a search
+through one word. Neither depends on how far apart the dates are.
+****************************************************************************/
+
+#include <algorithm>
+
+#include "Date.hpp"
+
+namespace vtsu {
+
+    namespace {
+
+        const long total_days = Date::last_day - Date::first_day + 1;
+
+        inline int popcount( std::uint64_t word )
+        {
+#if defined( __GNUC__ )
+            return __builtin_popcountll( word );
+#else
+            word = word - ( ( word >> 1 ) & 0x5555555555555555ULL );
+            word = ( word & 0x3333333333333333ULL ) + ( ( word >> 2 ) & 0x3333333333333333ULL );
+            word = ( word + ( word >> 4 ) ) & 0x0F0F0F0F0F0F0F0FULL;
+            return static_cast<int>( ( word * 0x0101010101010101ULL ) >> 56 );
+#endif
+        }
+
+        // Returns the position of the set bit in word that has n set bits below it.
+        inline int select_bit( std::uint64_t word, long n )
+        {
+            for( ; n > 0; --n ) word &= word - 1;
+            int position = 0;
+            while( ( word & 1 ) == 0 ) {
+                word >>= 1;
+                ++position;
+            }
+            return position;
+        }
+
+    }
+
+
+    //
+    // BusinessCalendar::BusinessCalendar( const std::vector<Date> &, unsigned )
+    //
+    // Holidays that fall on a weekend day are harmless; their bit is already clear.
+    //
+    BusinessCalendar::BusinessCalendar( const std::vector<Date> &holidays, unsigned weekend ) :
+        bits( static_cast<std::size_t>( ( total_days + 63 ) / 64 ), 0 ),
+        before( bits.size( ), 0 )
+    {
+        int weekday = Date::from_day_number( Date::first_day ).day_of_week( );
+        for( long i = 0; i < total_days; ++i ) {
+            if( ( weekend & ( 1U << weekday ) ) == 0 ) {
+                bits[i / 64] |= std::uint64_t( 1 ) << ( i % 64 );
+            }
+            if( ++weekday == 7 ) weekday = 0;
+        }
+
+        for( const Date &holiday : holidays ) {
+            const long i = holiday.day_number( ) - Date::first_day;
+            bits[i / 64] &= ~( std::uint64_t( 1 ) << ( i % 64 ) );
+        }
+
+        long running = 0;
+        for( std::size_t w = 0; w < bits.size( ); ++w ) {
+            before[w] = running;
+            running += popcount( bits[w] );
+        }
+    }
+
+
+    bool BusinessCalendar::is_business_day( const Date &date ) const
+    {
+        const long i = date.day_number( ) - Date::first_day;
+        return ( bits[i / 64] >> ( i % 64 ) ) & 1;
+    }
+
+
+    //
+    // BusinessCalendar::rank( long )
+    //
+    // The day may be one past the end of the range, so that ranges ending with the last day
+    // can be counted.
+    //
+    long BusinessCalendar::rank( long day ) const
+    {
+        const long i = day - Date::first_day;
+        const std::size_t w = static_cast<std::size_t>( i / 64 );
+        if( w == bits.size( ) ) return before.back( ) + popcount( bits.back( ) );
+
+        const std::uint64_t below = ( std::uint64_t( 1 ) << ( i % 64 ) ) - 1;
+        return before[w] + popcount( bits[w] & below );
+    }
+
+
+    //
+    // BusinessCalendar::select( long )
+    //
+    // The index must be less than the number of business days in the range. The word holding
+    // the day is the last one with fewer business days before it than index + 1.
+    //
+    long BusinessCalendar::select( long index ) const
+    {
+        const auto w = std::upper_bound( before.begin( ), before.end( ), index ) - before.begin( ) - 1;
+        const long bit = select_bit( bits[w], index - before[w] );
+        return Date::first_day + 64L * w + bit;
+    }
+
+
+    long BusinessCalendar::count( const Date &first, const Date &last ) const
+    {
+        return rank( last.day_number( ) ) - rank( first.day_number( ) );
+    }
+
+
+    //
+    // BusinessCalendar::advance( const Date &, long )
+    //
+    // Going forward, the first business day after date has the rank of the day after date.
+    // Going backward, the first business day before date has one less than the rank of date.
+    // Either way the result is the business day |n| - 1 further along.
+    //
+    Date BusinessCalendar::advance( const Date &date, long n ) const
+    {
+        if( n == 0 ) return date;
+
+        const long day   = date.day_number( );
+        const long total = rank( Date::last_day + 1 );
+        long target;
+        if( n > 0 ) {
+            const long start = rank( day + 1 );
+            if( n > total - start ) return Date::from_day_number( Date::last_day );
+            target = start + n - 1;
+        }
+        else {
+            const long start = rank( day );
+            if( -n > start ) return Date::from_day_number( Date::first_day );
+            target = start + n;
+        }
+        return Date::from_day_number( select( target ) );
+    }
+
+} // namespace vtsu
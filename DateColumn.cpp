@@ -0,0 +1,112 @@
+/****************************************************************************
+FILE          : DateColumn.cpp
+LAST REVISED  : 2026-10-17
+SUBJECT       : Columns of packed dates
+PROGRAMMER    : (C) Copyright 2023 by Peter Chapin
+
+The scans in this file are written without branches in their loop bodies so that the compiler
+can vectorize them. A day number d is in [first, last) exactly when d - first, taken as an
+unsigned number, is less than last - first; that turns the two comparisons into one. Selecting
+rows stores every row and only advances the output position past the rows that match, so it
+needs no branch either.
+****************************************************************************/
+
+#include <algorithm>
+
+#include "Date.hpp"
+
+namespace vtsu {
+
+    namespace {
+
+        // The bounds of [first, last) for the unsigned comparison described above.
+        struct Window {
+            std::uint32_t low;
+            std::uint32_t width;
+        };
+
+        inline Window make_window( const Date &first, const Date &last )
+        {
+            Window window;
+            window.low   = static_cast<std::uint32_t>( first.day_number( ) );
+            window.width = ( last < first ) ? 0 : static_cast<std::uint32_t>( last - first );
+            return window;
+        }
+
+        inline bool in_window( std::int32_t day, const Window &window )
+        {
+            return static_cast<std::uint32_t>( day ) - window.low < window.width;
+        }
+
+    }
+
+
+    DateColumn::DateColumn( const Date *dates, std::size_t count ) : days( count )
+    {
+        for( std::size_t i = 0; i < count; ++i ) {
+            days[i] = static_cast<std::int32_t>( dates[i].day_number( ) );
+        }
+    }
+
+
+    Date DateColumn::min( ) const
+    {
+        return Date::from_day_number( *std::min_element( days.begin( ), days.end( ) ) );
+    }
+
+
+    Date DateColumn::max( ) const
+    {
+        return Date::from_day_number( *std::max_element( days.begin( ), days.end( ) ) );
+    }
+
+
+    std::size_t DateColumn::count( const Date &first, const Date &last ) const
+    {
+        const Window window = make_window( first, last );
+        const std::int32_t *p = days.data( );
+        const std::size_t   n = days.size( );
+
+        std::size_t result = 0;
+        for( std::size_t i = 0; i < n; ++i ) {
+            result += in_window( p[i], window );
+        }
+        return result;
+    }
+
+
+    DateColumn DateColumn::select( const Date &first, const Date &last ) const
+    {
+        const Window window = make_window( first, last );
+        const std::size_t n = days.size( );
+
+        DateColumn result;
+        result.days.resize( n );
+        std::int32_t *out = result.days.data( );
+        std::size_t   k   = 0;
+        for( std::size_t i = 0; i < n; ++i ) {
+            out[k] = days[i];
+            k += in_window( days[i], window );
+        }
+        result.days.resize( k );
+        return result;
+    }
+
+
+    std::vector<std::size_t> DateColumn::rows( const Date &first, const Date &last ) const
+    {
+        const Window window = make_window( first, last );
+        const std::size_t n = days.size( );
+
+        std::vector<std::size_t> result( n );
+        std::size_t *out = result.data( );
+        std::size_t  k   = 0;
+        for( std::size_t i = 0; i < n; ++i ) {
+            out[k] = i;
+            k += in_window( days[i], window );
+        }
+        result.resize( k );
+        return result;
+    }
+
+} // namespace vtsu
@@ -0,0 +1,126 @@
+/****************************************************************************
+FILE          : DateFormat.cpp
+LAST REVISED  : 2026-10-17
+SUBJECT       : Fast formatting of dates as text
+PROGRAMMER    : (C) Copyright 2023 by Peter Chapin
+
+Writing a date with the stream operators means formatting three separate numbers, each with
+its own width and fill handling. The functions here write the text directly into a buffer. Each
+field is made of two digit pieces that are copied out of a table of the text for 00 through 99,
+which replaces most of the divisions a general number conversion would need.
+****************************************************************************/
+
+#include <cstring>
+
+#include "Date.hpp"
+
+namespace vtsu {
+
+    namespace {
+
+        // The text of the numbers 00 through 99, two characters each.
+        const char two_digits[] =
+            "00010203040506070809"
+            "10111213141516171819"
+            "20212223242526272829"
+            "30313233343536373839"
+            "40414243444546474849"
+            "50515253545556575859"
+            "60616263646566676869"
+            "70717273747576777879"
+            "80818283848586878889"
+            "90919293949596979899";
+
+        // Writes the two digits of value, which must be in the range 0 to 99.
+        inline char *put_two( char *p, int value )
+        {
+            std::memcpy( p, &two_digits[2 * value], 2 );
+            return p + 2;
+        }
+
+        inline char *put_year( char *p, int year )
+        {
+            p = put_two( p, year / 100 );
+            return put_two( p, year % 100 );
+        }
+
+    }
+
+
+    //
+    // format_date( char *, const Date &, DateFormat )
+    //
+    char *format_date( char *buffer, const Date &date, DateFormat format )
+    {
+        int day, month, year;
+        date.get( day, month, year );
+
+        char *p = buffer;
+        switch( format ) {
+        case DateFormat::iso:
+            p = put_year( p, year );
+            *p++ = '-';
+            p = put_two( p, month );
+            *p++ = '-';
+            p = put_two( p, day );
+            break;
+
+        case DateFormat::compact:
+            p = put_year( p, year );
+            p = put_two( p, month );
+            p = put_two( p, day );
+            break;
+
+        case DateFormat::us:
+            p = put_two( p, month );
+            *p++ = '/';
+            p = put_two( p, day );
+            *p++ = '/';
+            p = put_year( p, year );
+            break;
+
+        case DateFormat::european:
+            p = put_two( p, day );
+            *p++ = '.';
+            p = put_two( p, month );
+            *p++ = '.';
+            p = put_year( p, year );
+            break;
+        }
+        return p;
+    }
+
+
+    //
+    // format_dates( char *, const Date *, std::size_t, char, DateFormat )
+    //
+    // The format is checked once rather than for every date, so the loop for the common ISO
+    // format has no branches.
+    //
+    char *format_dates(
+        char *buffer, const Date *dates, std::size_t count, char separator, DateFormat format )
+    {
+        char *p = buffer;
+        if( format == DateFormat::iso ) {
+            for( std::size_t i = 0; i < count; ++i ) {
+                int day, month, year;
+                dates[i].get( day, month, year );
+                p = put_year( p, year );
+                p[0] = '-';
+                put_two( p + 1, month );
+                p[3] = '-';
+                put_two( p + 4, day );
+                p[6] = separator;
+                p += 7;
+            }
+        }
+        else {
+            for( std::size_t i = 0; i < count; ++i ) {
+                p = format_date( p, dates[i], format );
+                *p++ = separator;
+            }
+        }
+        return p;
+    }
+
+} // namespace vtsu
@@ -0,0 +1,147 @@
+/****************************************************************************
+FILE          : DateParse.cpp
+LAST REVISED  : 2026-10-17
+SUBJECT       : Bulk parsing of dates from text
+PROGRAMMER    : (C) Copyright 2023 by Peter Chapin
+
+Reading dates one at a time with operator>> is slow because every field goes through the
+stream's formatted extraction, with its locale and error handling. This file contains a parser
+for large amounts of text in the fixed form yyyy-mm-dd.
+
+Every date has the same layout, so on x86-64 the ten characters of a date (and a few after
+it) are examined at once with SSE2 instructions. One comparison checks all the digit and
+dash positions, and multiply-add instructions combine the digits of each field into numbers.
+Other targets, and the last few dates near the end of the text, use the ordinary loop.
+****************************************************************************/
+
+#include "Date.hpp"
+
+#if defined( __SSE2__ ) || defined( _M_X64 )
+    #define VTSU_DATE_SSE2 1
+    #include <emmintrin.h>
+#else
+    #define VTSU_DATE_SSE2 0
+#endif
+
+namespace vtsu {
+
+    namespace {
+
+        inline bool is_digit( char ch )
+        {
+            return static_cast<unsigned char>( ch - '0' ) <= 9;
+        }
+
+        // Reads the number in the n digit field at text. Returns -1 if there is a non-digit.
+        inline int read_field( const char *text, int n )
+        {
+            int value = 0;
+            for( int i = 0; i < n; ++i ) {
+                if( !is_digit( text[i] ) ) return -1;
+                value = 10 * value + ( text[i] - '0' );
+            }
+            return value;
+        }
+
+        // Splits the date at text into its fields. The text must have at least size characters.
+        // Returns false if it isn't of the form yyyy-mm-dd followed by a non-digit (or the end
+        // of the text).
+        //
+        bool split_date( const char *text, std::size_t size, int &year, int &month, int &day )
+        {
+            if( size < 10 || text[4] != '-' || text[7] != '-' ) return false;
+            if( size > 10 && is_digit( text[10] ) ) return false;
+            year  = read_field( text,     4 );
+            month = read_field( text + 5, 2 );
+            day   = read_field( text + 8, 2 );
+            return year >= 0 && month >= 0 && day >= 0;
+        }
+
+#if VTSU_DATE_SSE2
+        //
+        // split_date_sse2
+        //
+        // Does the same job as split_date using the 16 characters at text. A character c is a
+        // digit if c - '0' is between 0 and 9 as a signed byte; characters above '9' or with the
+        // high bit set fall outside that range either way. The digits are widened to 16 bits
+        // and multiplied by their place values, and adjacent pairs of products are summed.
+        // This leaves the year in two parts, the month in two parts, and the day in one.
+        //
+        bool split_date_sse2( const char *text, int &year, int &month, int &day )
+        {
+            const __m128i chunk  = _mm_loadu_si128( reinterpret_cast<const __m128i *>( text ) );
+            const __m128i values = _mm_sub_epi8( chunk, _mm_set1_epi8( '0' ) );
+            const __m128i digits = _mm_and_si128(
+                _mm_cmpgt_epi8( values, _mm_set1_epi8( -1 ) ),
+                _mm_cmplt_epi8( values, _mm_set1_epi8( 10 ) ) );
+            const __m128i dashes = _mm_cmpeq_epi8( chunk, _mm_set1_epi8( '-' ) );
+
+            // Digits in positions 0-3, 5-6, and 8-9 but not 10. Dashes in positions 4 and 7.
+            const int digit_mask = _mm_movemask_epi8( digits ) & 0x7FF;
+            const int dash_mask  = _mm_movemask_epi8( dashes ) & 0x090;
+            if( digit_mask != 0x36F || dash_mask != 0x090 ) return false;
+
+            const __m128i zero  = _mm_setzero_si128( );
+            const __m128i first = _mm_madd_epi16( _mm_unpacklo_epi8( values, zero ),
+                _mm_setr_epi16( 1000, 100, 10, 1, 0, 10, 1, 0 ) );
+            const __m128i last  = _mm_madd_epi16( _mm_unpackhi_epi8( values, zero ),
+                _mm_setr_epi16( 10, 1, 0, 0, 0, 0, 0, 0 ) );
+
+            alignas( 16 ) int parts[4];
+            _mm_store_si128( reinterpret_cast<__m128i *>( parts ), first );
+            year  = parts[0] + parts[1];
+            month = parts[2] + parts[3];
+            day   = _mm_cvtsi128_si32( last );
+            return true;
+        }
+#endif
+
+    }
+
+
+    //
+    // parse_dates( const char *, const char *, std::vector<Date> & )
+    //
+    // The SSE2 version looks at 16 characters, so it is only used while that many remain.
+    //
+    const char *parse_dates( const char *first, const char *last, std::vector<Date> &dates )
+    {
+        // Most files have one date and one separator per line. The capacity still grows
+        // geometrically when a large file is parsed in pieces.
+        //
+        const std::size_t needed = dates.size( ) + static_cast<std::size_t>( last - first ) / 11;
+        if( needed > dates.capacity( ) ) {
+            dates.reserve( needed > 2 * dates.capacity( ) ? needed : 2 * dates.capacity( ) );
+        }
+
+        const char *p = first;
+        for( ;; ) {
+            while( p != last && !is_digit( *p ) ) ++p;
+            if( p == last ) return last;
+
+            const std::size_t remaining = static_cast<std::size_t>( last - p );
+            int year, month, day;
+            bool valid;
+#if VTSU_DATE_SSE2
+            if( remaining >= 16 ) valid = split_date_sse2( p, year, month, day );
+            else
+#endif
+                valid = split_date( p, remaining, year, month, day );
+
+            if( !valid || month < 1 || month > 12 ) return p;
+            if( day < 1 || day > Date::month_length( month, year ) ) return p;
+
+            // Feb 29 of a leap year outside the range becomes Feb 28 of a year that isn't.
+            if( year < 1800 || year > 2099 ) {
+                year = ( year < 1800 ) ? 1800 : 2099;
+                if( day > Date::month_length( month, year ) ) day = Date::month_length( month, year );
+            }
+
+            Date date;
+            date.serial = static_cast<int>( Date::days_from_civil( day, month, year ) );
+            dates.push_back( date );
+            p += 10;
+        }
+    }
+
+} // namespace vtsu
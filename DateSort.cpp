@@ -0,0 +1,154 @@
+/****************************************************************************
+FILE          : DateSort.cpp
+LAST REVISED  : 2026-10-17
+SUBJECT       : Sorting and grouping dates in linear time
+PROGRAMMER    : (C) Copyright 2023 by Peter Chapin
+
+Comparison sorts take no advantage of the small number of possible dates. There are only
+109,573 days in the supported range, so dates can be sorted by counting how many times each day
+occurs and then writing out each day that many times. Grouping works the same way with a count
+for each period: the counts give the position of every group in the output, and each row is
+then stored directly into its group.
+****************************************************************************/
+
+#include <algorithm>
+#include <limits>
+
+#include "Date.hpp"
+
+namespace vtsu {
+
+    namespace {
+
+        const long total_days = Date::last_day - Date::first_day + 1;
+
+        // Below this many dates, clearing and scanning a count for every day costs more than
+        // a comparison sort.
+        //
+        const std::size_t counting_threshold = 8192;
+
+        // Counts the days in [first, first + count) and writes them back in order. The day
+        // number of each item is given by key( item ), and make( day ) creates the item for a
+        // day. Smaller counters keep the table of counts small enough to stay in the cache.
+        //
+        template<typename Counter, typename Item, typename Key, typename Make>
+        void counting_sort( Item *first, std::size_t count, Key key, Make make )
+        {
+            std::vector<Counter> counts( static_cast<std::size_t>( total_days ), 0 );
+            for( std::size_t i = 0; i < count; ++i ) {
+                ++counts[static_cast<std::size_t>( key( first[i] ) - Date::first_day )];
+            }
+
+            Item *p = first;
+            for( long day = 0; day < total_days; ++day ) {
+                if( counts[day] != 0 ) p = std::fill_n( p, counts[day], make( Date::first_day + day ) );
+            }
+        }
+
+        template<typename Item, typename Key, typename Make>
+        void sort_days( Item *first, std::size_t count, Key key, Make make )
+        {
+            if( count < counting_threshold ) {
+                std::sort( first, first + count,
+                    [key]( const Item &left, const Item &right ) { return key( left ) < key( right ); } );
+            }
+            else if( count <= std::numeric_limits<std::uint32_t>::max( ) ) {
+                counting_sort<std::uint32_t>( first, count, key, make );
+            }
+            else {
+                counting_sort<std::size_t>( first, count, key, make );
+            }
+        }
+
+    }
+
+
+    void sort_dates( Date *dates, std::size_t count )
+    {
+        sort_days( dates, count,
+            []( const Date &date ) { return date.day_number( ); },
+            []( long day ) { return Date::from_day_number( day ); } );
+    }
+
+
+    void DateColumn::sort( )
+    {
+        sort_days( days.data( ), days.size( ),
+            []( std::int32_t day ) { return static_cast<long>( day ); },
+            []( long day ) { return static_cast<std::int32_t>( day ); } );
+    }
+
+
+    //
+    // sort_order( const Date *, std::size_t )
+    //
+    // Each date's offset from Date::first_day (17 bits) is packed above its row number (47
+    // bits) in one 64 bit word. The radix passes then move only the words, and since the row
+    // number is in the low bits the passes never have to look anything up.
+    //
+    std::vector<std::size_t> sort_order( const Date *dates, std::size_t count )
+    {
+        const int row_bits = 47;
+        const std::uint64_t row_mask = ( std::uint64_t( 1 ) << row_bits ) - 1;
+
+        std::vector<std::uint64_t> items( count );
+        std::vector<std::size_t> low_counts( 512 + 1, 0 );
+        std::vector<std::size_t> high_counts( 256 + 1, 0 );
+        for( std::size_t i = 0; i < count; ++i ) {
+            const std::uint64_t key = static_cast<std::uint64_t>( dates[i].day_number( ) - Date::first_day );
+            items[i] = ( key << row_bits ) | i;
+            ++low_counts[( key & 511 ) + 1];
+            ++high_counts[( key >> 9 ) + 1];
+        }
+        for( std::size_t k = 1; k < low_counts.size( ); ++k )  low_counts[k]  += low_counts[k - 1];
+        for( std::size_t k = 1; k < high_counts.size( ); ++k ) high_counts[k] += high_counts[k - 1];
+
+        std::vector<std::uint64_t> buffer( count );
+        for( std::size_t i = 0; i < count; ++i ) {
+            buffer[low_counts[( items[i] >> row_bits ) & 511]++] = items[i];
+        }
+        for( std::size_t i = 0; i < count; ++i ) {
+            items[high_counts[buffer[i] >> ( row_bits + 9 )]++] = buffer[i];
+        }
+
+        std::vector<std::size_t> order( count );
+        for( std::size_t i = 0; i < count; ++i ) {
+            order[i] = static_cast<std::size_t>( items[i] & row_mask );
+        }
+        return order;
+    }
+
+
+    //
+    // group_dates( const Date *, std::size_t, DatePeriod, std::vector<std::size_t> & )
+    //
+    std::vector<DateGroup> group_dates(
+        const Date *dates, std::size_t count, DatePeriod period, std::vector<std::size_t> &order )
+    {
+        const std::size_t periods = static_cast<std::size_t>( period_count( period ) );
+
+        std::vector<std::uint32_t> keys( count );
+        std::vector<std::size_t> positions( periods + 1, 0 );
+        for( std::size_t i = 0; i < count; ++i ) {
+            keys[i] = static_cast<std::uint32_t>( period_index( dates[i], period ) );
+            ++positions[keys[i] + 1];
+        }
+
+        std::vector<DateGroup> groups;
+        for( std::size_t k = 0; k < periods; ++k ) {
+            const std::size_t size = positions[k + 1];
+            positions[k + 1] += positions[k];
+            if( size != 0 ) {
+                DateGroup group = { period_start( static_cast<long>( k ), period ), positions[k], size };
+                groups.push_back( group );
+            }
+        }
+
+        order.resize( count );
+        for( std::size_t i = 0; i < count; ++i ) {
+            order[positions[keys[i]]++] = i;
+        }
+        return groups;
+    }
+
+} // namespace vtsu
@@ -0,0 +1,568 @@
+/****************************************************************************
+FILE          : DateTest.cpp
+LAST REVISED  : 2026-10-17
+SUBJECT       : Regression test for the date handling library
+PROGRAMMER    : (C) Copyright 2023 by Peter Chapin
+
+The supported range has only 109,573 days, so this program checks every one of them. The
+expected answers come from a calendar that is stepped forward one day at a time with nothing
+but the month lengths, which is slow but too simple to be wrong in the same way as the day
+number arithmetic in Date.hpp.
+
+The program prints each failure and exits with a failure status if there are any. It is run by
+ctest.
+****************************************************************************/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <iterator>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "Date.hpp"
+
+using vtsu::Date;
+
+namespace {
+
+    std::mt19937 generator( 20231017 );
+    int failures = 0;
+
+    void check( bool condition, const char *what, std::size_t test )
+    {
+        if( !condition ) {
+            ++failures;
+            std::cout << "FAILED: " << what << " (case " << test << ")" << std::endl;
+        }
+    }
+
+    // One day of the reference calendar.
+    struct Civil {
+        int  day;
+        int  month;
+        int  year;
+        int  day_of_week;   // 0 for Sunday.
+        int  day_of_year;
+    };
+
+    // Returns every day in the supported range, in order. Jan 1, 1800 was a Wednesday.
+    std::vector<Civil> make_calendar( )
+    {
+        std::vector<Civil> calendar;
+        Civil c = { 1, 1, 1800, 3, 1 };
+        while( c.year <= 2099 ) {
+            calendar.push_back( c );
+            const bool leap = ( c.year % 4 == 0 && c.year % 100 != 0 ) || c.year % 400 == 0;
+            const int  lengths[] = { 31, leap ? 29 : 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+            c.day_of_week = ( c.day_of_week + 1 ) % 7;
+            ++c.day_of_year;
+            if( ++c.day > lengths[c.month - 1] ) {
+                c.day = 1;
+                if( ++c.month > 12 ) {
+                    c.month = 1;
+                    c.day_of_year = 1;
+                    ++c.year;
+                }
+            }
+        }
+        return calendar;
+    }
+
+    // The day number of calendar[i] is Date::first_day + i.
+    Date date_of( long i ) { return Date::from_day_number( Date::first_day + i ); }
+
+    // The serial day number representation: construction, get/set, and the day arithmetic.
+    void check_serial( const std::vector<Civil> &calendar )
+    {
+        const long size = static_cast<long>( calendar.size( ) );
+        check( size == Date::last_day - Date::first_day + 1, "size of the supported range", size );
+
+        for( long i = 0; i < size; ++i ) {
+            const Civil &c = calendar[i];
+            const Date date( c.day, c.month, c.year );
+            check( date.day_number( ) == Date::first_day + i, "day_number", i );
+            check( date == date_of( i ), "from_day_number", i );
+
+            int day = 0, month = 0, year = 0;
+            date.get( day, month, year );
+            check( day == c.day && month == c.month && year == c.year, "get", i );
+            check( date.day( ) == c.day && date.month( ) == c.month && date.year( ) == c.year,
+                   "day, month, and year", i );
+            check( date.day_of_week( ) == c.day_of_week, "day_of_week", i );
+            check( date.day_of_year( ) == c.day_of_year, "day_of_year", i );
+            check( Date::is_valid( c.day, c.month, c.year ), "is_valid", i );
+
+            Date other;
+            other.set( c.day, c.month, c.year );
+            check( other == date, "set", i );
+
+            // Steps of assorted sizes in both directions, including ones that are forced back
+            // into the range.
+            for( long delta : { 1L, -1L, 30L, -365L, 146097L, -1000000L } ) {
+                Date moved = date;
+                moved.advance( delta );
+                const long expected = std::min( std::max( i + delta, 0L ), size - 1 );
+                check( moved == date_of( expected ), "advance", i );
+                check( moved - date == expected - i, "difference", i );
+            }
+        }
+
+        // Values outside the range are forced into it.
+        check( Date( 1, 1, 1700 ) == date_of( 0 ), "year before the range", 0 );
+        check( Date( 31, 12, 2500 ) == date_of( size - 1 ), "year after the range", 0 );
+        check( Date( 31, 2, 2000 ) == Date( 29, 2, 2000 ), "day past the end of the month", 0 );
+        check( !Date::is_valid( 29, 2, 1900 ), "is_valid on Feb 29, 1900", 0 );
+    }
+
+    // The text of a day of the reference calendar in the given format, made with the C library.
+    std::string text_of( const Civil &c, vtsu::DateFormat format = vtsu::DateFormat::iso )
+    {
+        char buffer[16] = "";
+        switch( format ) {
+        case vtsu::DateFormat::iso:
+            std::snprintf( buffer, sizeof( buffer ), "%04d-%02d-%02d", c.year, c.month, c.day );
+            break;
+        case vtsu::DateFormat::compact:
+            std::snprintf( buffer, sizeof( buffer ), "%04d%02d%02d", c.year, c.month, c.day );
+            break;
+        case vtsu::DateFormat::us:
+            std::snprintf( buffer, sizeof( buffer ), "%02d/%02d/%04d", c.month, c.day, c.year );
+            break;
+        case vtsu::DateFormat::european:
+            std::snprintf( buffer, sizeof( buffer ), "%02d.%02d.%04d", c.day, c.month, c.year );
+            break;
+        }
+        return buffer;
+    }
+
+    // Every day in the supported range, in order.
+    std::vector<Date> all_dates( )
+    {
+        std::vector<Date> dates;
+        for( long day = Date::first_day; day <= Date::last_day; ++day ) {
+            dates.push_back( Date::from_day_number( day ) );
+        }
+        return dates;
+    }
+
+    // The calendar core is constexpr, so these are worked out by the compiler.
+    constexpr Date leap_day( 29, 2, 2000 );
+    static_assert( leap_day.day_of_year( ) == 60, "constexpr day_of_year" );
+    static_assert( leap_day.day_of_week( ) == 2, "constexpr day_of_week" );
+    static_assert( leap_day.day_number( ) == 11016, "constexpr day_number" );
+    static_assert( Date::from_day_number( 11016 ).month( ) == 2, "constexpr from_day_number" );
+    static_assert( Date( 31, 12, 1899 ).day_of_year( ) == 365, "constexpr common year" );
+    static_assert( vtsu::month_table.before[1][12] == 366, "constexpr month_table" );
+    static_assert( !Date::is_valid( 29, 2, 2100 ), "constexpr is_valid" );
+
+    // The month tables against the reference calendar's month lengths.
+    void check_month_table( const std::vector<Civil> &calendar )
+    {
+        for( std::size_t i = 0; i < calendar.size( ); ++i ) {
+            const Civil &c = calendar[i];
+            const bool last_of_month = i + 1 == calendar.size( ) || calendar[i + 1].day == 1;
+            if( last_of_month ) {
+                check( Date::month_length( c.month, c.year ) == c.day, "month_length", i );
+                const int leap = Date::is_leap( c.year );
+                check( vtsu::month_table.before[leap][c.month] == c.day_of_year,
+                       "month_table.before", i );
+            }
+        }
+    }
+
+    // Bulk parsing. The fast path and the ordinary loop are both used because the text ends
+    // with too few characters for the fast path.
+    void check_parse( const std::vector<Civil> &calendar )
+    {
+        const char *separators[] = { "\n", ",", "\r\n", " ; " };
+        std::string text;
+        for( std::size_t i = 0; i < calendar.size( ); ++i ) {
+            text += text_of( calendar[i] );
+            text += separators[i % 4];
+        }
+
+        std::vector<Date> dates;
+        const char *end = vtsu::parse_dates( text.data( ), text.data( ) + text.size( ), dates );
+        check( end == text.data( ) + text.size( ), "parse_dates read all the text", 0 );
+        check( dates.size( ) == calendar.size( ), "parse_dates count", 0 );
+        for( std::size_t i = 0; i < dates.size( ) && i < calendar.size( ); ++i ) {
+            check( dates[i] == date_of( i ), "parse_dates", i );
+        }
+
+        // Parsing stops at an impossible date, and years outside the range are forced into it.
+        const std::string bad = "2001-02-28\n1700-06-01\n2500-06-01\n2001-02-29\n2001-03-01\n";
+        dates.clear( );
+        end = vtsu::parse_dates( bad.data( ), bad.data( ) + bad.size( ), dates );
+        check( end == bad.data( ) + 33, "parse_dates stops at Feb 29, 2001", 0 );
+        check( dates.size( ) == 3 && dates[0] == Date( 28, 2, 2001 ) &&
+               dates[1] == Date( 1, 6, 1800 ) && dates[2] == Date( 1, 6, 2099 ),
+               "parse_dates results before Feb 29, 2001", 0 );
+    }
+
+    // Formatting in every format, one date at a time and in bulk, and the stream operators.
+    void check_format( const std::vector<Civil> &calendar )
+    {
+        using vtsu::DateFormat;
+        const DateFormat formats[] = {
+            DateFormat::iso, DateFormat::compact, DateFormat::us, DateFormat::european };
+
+        const std::vector<Date> dates = all_dates( );
+        std::vector<char> bulk( dates.size( ) * ( vtsu::max_date_text + 1 ) );
+
+        for( DateFormat format : formats ) {
+            std::string expected;
+            for( std::size_t i = 0; i < calendar.size( ); ++i ) {
+                const std::string text = text_of( calendar[i], format );
+                char buffer[vtsu::max_date_text];
+                char *end = vtsu::format_date( buffer, dates[i], format );
+                check( std::string( buffer, end ) == text, "format_date", i );
+                expected += text;
+                expected += '|';
+            }
+
+            char *end =
+                vtsu::format_dates( bulk.data( ), dates.data( ), dates.size( ), '|', format );
+            check( std::string( bulk.data( ), end ) == expected, "format_dates", 0 );
+        }
+
+        // The stream operators round trip every date and leave the stream's fill alone.
+        std::stringstream stream;
+        stream << std::setfill( '*' );
+        for( const Date &date : dates ) stream << date << '\n';
+        check( stream.fill( ) == '*', "operator<< changed the fill character", 0 );
+        for( std::size_t i = 0; i < dates.size( ); ++i ) {
+            Date date;
+            stream >> date;
+            check( stream && date == dates[i], "operator>>", i );
+        }
+
+        std::ostringstream wide;
+        wide << std::setw( 12 ) << Date( 4, 7, 1976 );
+        check( wide.str( ) == "  1976-07-04", "field width applies to the whole date", 0 );
+    }
+
+    // The batch operations over the whole range at once.
+    void check_batch( const std::vector<Civil> &calendar )
+    {
+        const std::vector<Date> dates = all_dates( );
+        const std::size_t count = dates.size( );
+
+        std::vector<int> days( count ), months( count ), years( count );
+        vtsu::split_all( days.data( ), months.data( ), years.data( ), dates.data( ), count );
+        for( std::size_t i = 0; i < count; ++i ) {
+            const Civil &c = calendar[i];
+            check( days[i] == c.day && months[i] == c.month && years[i] == c.year, "split_all", i );
+        }
+
+        vtsu::day_of_week_all( days.data( ), dates.data( ), count );
+        for( std::size_t i = 0; i < count; ++i ) {
+            check( days[i] == calendar[i].day_of_week, "day_of_week_all", i );
+        }
+
+        vtsu::day_of_year_all( days.data( ), dates.data( ), count );
+        for( std::size_t i = 0; i < count; ++i ) {
+            check( days[i] == calendar[i].day_of_year, "day_of_year_all", i );
+        }
+
+        // The differences between the range and the range backwards.
+        const std::vector<Date> backwards( dates.rbegin( ), dates.rend( ) );
+        std::vector<long> differences( count );
+        vtsu::difference_all( differences.data( ), dates.data( ), backwards.data( ), count );
+        for( std::size_t i = 0; i < count; ++i ) {
+            check( differences[i] == dates[i] - backwards[i], "difference_all", i );
+        }
+
+        for( long delta : { 1L, -1L, 1000L, -40000L, 200000L, -2000000000L } ) {
+            std::vector<Date> moved = dates;
+            vtsu::advance_all( moved.data( ), count, delta );
+            for( std::size_t i = 0; i < count; ++i ) {
+                Date expected = dates[i];
+                expected.advance( delta );
+                check( moved[i] == expected, "advance_all", i );
+            }
+        }
+    }
+
+    static_assert( std::is_same<std::iterator_traits<vtsu::DateRange::iterator>::iterator_category,
+                                std::random_access_iterator_tag>::value,
+                   "DateRange::iterator is not random access" );
+
+    // Ranges with the standard algorithms, which must see random access iterators to take
+    // constant time. The standard library only allows moving an iterator backward with
+    // std::advance if it is at least bidirectional.
+    void check_range( )
+    {
+        const std::vector<Date> dates = all_dates( );
+        const long size = static_cast<long>( dates.size( ) );
+        const vtsu::DateRange all( dates.front( ), size + 10 );
+        check( all.size( ) == size, "range stops at the last day", 0 );
+        check( std::distance( all.begin( ), all.end( ) ) == size, "std::distance", 0 );
+        check( std::equal( all.begin( ), all.end( ), dates.begin( ), dates.end( ) ), "range", 0 );
+        check( std::is_sorted( all.begin( ), all.end( ) ), "std::is_sorted", 0 );
+
+        for( std::size_t i = 0; i < 1000; ++i ) {
+            const long first = static_cast<long>( generator( ) % size );
+            const long n     = static_cast<long>( generator( ) % ( size - first ) );
+            const vtsu::DateRange range( dates[first], dates[first + n] );
+            check( std::distance( range.begin( ), range.end( ) ) == n, "std::distance", i );
+            check( range.end( ) - n == range.begin( ), "operator-", i );
+
+            vtsu::DateRange::iterator it = range.end( );
+            std::advance( it, -n );
+            check( it == range.begin( ), "std::advance backward", i );
+            if( n == 0 ) continue;
+
+            std::advance( it, n / 2 );
+            check( *it == dates[first + n / 2], "std::advance forward", i );
+            check( it->day_number( ) == dates[first + n / 2].day_number( ), "operator->", i );
+            check( *std::prev( range.end( ) ) == dates[first + n - 1], "std::prev", i );
+            check( range.begin( )[n - 1] == dates[first + n - 1], "operator[]", i );
+
+            const Date target = dates[first + generator( ) % n];
+            check( *std::lower_bound( range.begin( ), range.end( ), target ) == target,
+                   "std::lower_bound", i );
+
+            // Sorting a shuffled copy of the range gives the range back.
+            if( n < 5000 ) {
+                std::vector<Date> shuffled( range.begin( ), range.end( ) );
+                std::shuffle( shuffled.begin( ), shuffled.end( ), generator );
+                std::sort( shuffled.begin( ), shuffled.end( ) );
+                check( std::equal( shuffled.begin( ), shuffled.end( ), range.begin( ) ),
+                       "std::sort", i );
+            }
+        }
+    }
+
+    // Month and year arithmetic, against stepping through the reference calendar one month at
+    // a time.
+    void check_months( const std::vector<Civil> &calendar )
+    {
+        for( std::size_t i = 0; i < calendar.size( ); i += 7 ) {
+            const Civil &c = calendar[i];
+            for( long months : { 1L, -1L, 13L, -25L, 600L, -4000L } ) {
+                long index = c.year * 12L + ( c.month - 1 ) + months;
+                if( index < 1800 * 12 ) index = 1800 * 12;
+                if( index > 2099 * 12 + 11 ) index = 2099 * 12 + 11;
+                const int year  = static_cast<int>( index / 12 );
+                const int month = static_cast<int>( index % 12 ) + 1;
+                const int day   = std::min( c.day, Date::month_length( month, year ) );
+
+                Date moved( c.day, c.month, c.year );
+                moved.add_months( months );
+                check( moved == Date( day, month, year ), "add_months", i );
+                if( months % 12 == 0 ) {
+                    Date by_years( c.day, c.month, c.year );
+                    by_years.add_years( months / 12 );
+                    check( by_years == moved, "add_years", i );
+                }
+            }
+        }
+    }
+
+    // A business calendar with random holidays, against counting the days one at a time.
+    void check_business( )
+    {
+        const std::vector<Date> dates = all_dates( );
+        std::vector<Date> holidays;
+        std::vector<bool> is_holiday( dates.size( ), false );
+        for( int i = 0; i < 3000; ++i ) {
+            const std::size_t day = generator( ) % dates.size( );
+            holidays.push_back( dates[day] );
+            is_holiday[day] = true;
+        }
+
+        for( unsigned weekend : { vtsu::BusinessCalendar::saturday_and_sunday, 1U << 5, 0U } ) {
+            const vtsu::BusinessCalendar calendar( holidays, weekend );
+
+            // before[i] is the number of business days before dates[i].
+            std::vector<long> before( dates.size( ) + 1, 0 );
+            std::vector<long> business;
+            for( std::size_t i = 0; i < dates.size( ); ++i ) {
+                const bool open =
+                    ( weekend & ( 1U << dates[i].day_of_week( ) ) ) == 0 && !is_holiday[i];
+                check( calendar.is_business_day( dates[i] ) == open, "is_business_day", i );
+                before[i + 1] = before[i] + open;
+                if( open ) business.push_back( static_cast<long>( i ) );
+            }
+
+            for( std::size_t i = 0; i < 20000; ++i ) {
+                const long a = static_cast<long>( generator( ) % dates.size( ) );
+                const long b = static_cast<long>( generator( ) % dates.size( ) );
+                check( calendar.count( dates[a], dates[b] ) == before[b] - before[a], "count", i );
+
+                // The expected result of advance, by index into business.
+                const long n = static_cast<long>( generator( ) % 2000 ) - 1000;
+                long expected = a;
+                if( n > 0 ) {
+                    const long target = before[a + 1] + n - 1;
+                    expected = ( target < static_cast<long>( business.size( ) ) ) ?
+                        business[target] : static_cast<long>( dates.size( ) ) - 1;
+                }
+                else if( n < 0 ) {
+                    const long target = before[a] + n;
+                    expected = ( target >= 0 ) ? business[target] : 0;
+                }
+                check( calendar.advance( dates[a], n ) == dates[expected], "advance", i );
+            }
+        }
+    }
+
+    // Random dates from the whole range, with many repeats.
+    std::vector<Date> random_dates( std::size_t count )
+    {
+        const long size = Date::last_day - Date::first_day + 1;
+        std::vector<Date> dates;
+        for( std::size_t i = 0; i < count; ++i ) {
+            const long span = ( i % 2 == 0 ) ? size : 400;
+            dates.push_back( date_of( static_cast<long>( generator( ) % span ) ) );
+        }
+        return dates;
+    }
+
+    // A column against a plain array of the same dates.
+    void check_column( )
+    {
+        for( std::size_t count : { 1, 7, 1000, 50000 } ) {
+            const std::vector<Date> dates = random_dates( count );
+            vtsu::DateColumn column( dates.data( ), dates.size( ) );
+            check( column.size( ) == count, "DateColumn size", count );
+            check( column.min( ) == *std::min_element( dates.begin( ), dates.end( ) ),
+                   "DateColumn::min", count );
+            check( column.max( ) == *std::max_element( dates.begin( ), dates.end( ) ),
+                   "DateColumn::max", count );
+
+            for( std::size_t i = 0; i < 50; ++i ) {
+                Date first = dates[generator( ) % count];
+                Date last  = dates[generator( ) % count];
+                if( i % 5 == 0 ) last = first;
+                if( i % 7 == 0 ) first = date_of( 0 );
+
+                std::vector<std::size_t> expected_rows;
+                for( std::size_t row = 0; row < count; ++row ) {
+                    if( first <= dates[row] && dates[row] < last ) expected_rows.push_back( row );
+                }
+                check( column.count( first, last ) == expected_rows.size( ),
+                       "DateColumn::count", i );
+                check( column.rows( first, last ) == expected_rows, "DateColumn::rows", i );
+
+                const vtsu::DateColumn selected = column.select( first, last );
+                bool same = selected.size( ) == expected_rows.size( );
+                for( std::size_t k = 0; same && k < selected.size( ); ++k ) {
+                    same = selected[k] == dates[expected_rows[k]];
+                }
+                check( same, "DateColumn::select", i );
+            }
+
+            std::vector<Date> sorted = dates;
+            std::sort( sorted.begin( ), sorted.end( ) );
+            column.sort( );
+            bool same = column.size( ) == sorted.size( );
+            for( std::size_t k = 0; same && k < sorted.size( ); ++k ) {
+                same = column[k] == sorted[k] &&
+                       column.day_numbers( )[k] == sorted[k].day_number( );
+            }
+            check( same, "DateColumn::sort", count );
+        }
+    }
+
+    // The first day of the period that holds date, worked out from the calendar fields.
+    Date brute_force_start( const Date &date, vtsu::DatePeriod period )
+    {
+        switch( period ) {
+        case vtsu::DatePeriod::day:   return date;
+        case vtsu::DatePeriod::month: return Date( 1, date.month( ), date.year( ) );
+        case vtsu::DatePeriod::year:  return Date( 1, 1, date.year( ) );
+        }
+        return date;
+    }
+
+    // Sorting and grouping against std::sort, std::stable_sort, and a std::map of the groups.
+    // The sizes are on both sides of the size where sort_dates changes methods.
+    void check_sort_and_group( )
+    {
+        using vtsu::DatePeriod;
+        for( std::size_t count : { 0, 1, 100, 8191, 8192, 100000 } ) {
+            const std::vector<Date> dates = random_dates( count );
+
+            std::vector<Date> sorted = dates;
+            std::vector<Date> expected = dates;
+            vtsu::sort_dates( sorted.data( ), count );
+            std::sort( expected.begin( ), expected.end( ) );
+            check( sorted == expected, "sort_dates", count );
+
+            std::vector<std::size_t> expected_order( count );
+            std::iota( expected_order.begin( ), expected_order.end( ), std::size_t( 0 ) );
+            std::stable_sort( expected_order.begin( ), expected_order.end( ),
+                [&]( std::size_t left, std::size_t right ) { return dates[left] < dates[right]; } );
+            check( vtsu::sort_order( dates.data( ), count ) == expected_order,
+                   "sort_order", count );
+
+            for( DatePeriod period : { DatePeriod::day, DatePeriod::month, DatePeriod::year } ) {
+                std::map<long, std::vector<std::size_t>> expected_groups;
+                for( std::size_t row = 0; row < count; ++row ) {
+                    const Date start = brute_force_start( dates[row], period );
+                    expected_groups[start.day_number( )].push_back( row );
+                }
+
+                std::vector<std::size_t> order;
+                const std::vector<vtsu::DateGroup> groups =
+                    vtsu::group_dates( dates.data( ), count, period, order );
+                bool same = groups.size( ) == expected_groups.size( ) && order.size( ) == count;
+                auto expected_group = expected_groups.begin( );
+                for( std::size_t g = 0; same && g < groups.size( ); ++g, ++expected_group ) {
+                    const std::vector<std::size_t> &rows = expected_group->second;
+                    same = groups[g].start.day_number( ) == expected_group->first &&
+                           groups[g].count == rows.size( ) &&
+                           std::equal( rows.begin( ), rows.end( ),
+                                       order.begin( ) + static_cast<long>( groups[g].first ) );
+                }
+                check( same, "group_dates", count );
+
+                std::vector<long> values( count );
+                std::iota( values.begin( ), values.end( ), 1L );
+                const std::vector<long> sums =
+                    vtsu::sum_by_period( dates.data( ), values.data( ), count, period );
+                check( static_cast<long>( sums.size( ) ) == vtsu::period_count( period ),
+                       "sum_by_period size", count );
+                for( const auto &group : expected_groups ) {
+                    long expected_sum = 0;
+                    for( std::size_t row : group.second ) expected_sum += values[row];
+                    const Date start = Date::from_day_number( group.first );
+                    const long index = vtsu::period_index( start, period );
+                    check( sums[index] == expected_sum, "sum_by_period", count );
+                    check( vtsu::period_start( index, period ) == start, "period_start", count );
+                }
+            }
+        }
+    }
+
+}
+
+int main( )
+{
+    const std::vector<Civil> calendar = make_calendar( );
+    check_serial( calendar );
+    check_month_table( calendar );
+    check_parse( calendar );
+    check_format( calendar );
+    check_batch( calendar );
+    check_range( );
+    check_months( calendar );
+    check_business( );
+    check_column( );
+    check_sort_and_group( );
+
+    if( failures != 0 ) {
+        std::cout << failures << " checks failed\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "All checks passed\n";
+    return EXIT_SUCCESS;
+}
@@ -2,13 +2,23 @@
  *  \brief  A class that makes visible the action of the various special methods.
  *  \author Peter Chapin <peter.chapin@vermontstate.edu>
  *
- * This file contains an implementation of the Probe class. This version is not very useful for
- * real programs because it just spits out messages onto the standard output device. However,
- * one can imagine a production version of this class that logs messages to a file or that has
- * options regarding message disposition. Probe objects could be attached to objects either by
- * class membership, in cases where a new class is being defined, or by multiple inheritance in
- * cases where an existing class must be used. Could a useful debugging facility be created from
- * this? Perhaps.
+ * This file contains an implementation of the Probe class. By default it just spits out
+ * messages onto the standard output device, which is fine for small demonstrations but
+ * serializes every thread on one stream. While recording (see Probe.hpp), each thread instead
+ * stores its events in a ring buffer of its own. The ring has a single producer, the thread,
+ * and a single consumer, the background drain thread, so neither side needs a lock: each only
+ * writes its own index and reads the other's. A thread only takes a lock once per recording,
+ * to register its ring with the drain thread. If a ring fills, the thread yields until the
+ * drain thread makes room, so no events are lost. The drain thread writes the events of each
+ * ring in order, but events of different threads are interleaved in batches; the time stamps
+ * give the true order. Probe objects could be attached to objects either by class membership,
+ * in cases where a new class is being defined, or by multiple inheritance in cases where an
+ * existing class must be used.
+ *
+ * The binary format (see ProbeTrace.hpp) stores each field as a varint and each time stamp as
+ * the difference from the previous one of the same thread, so most events take a few bytes.
+ * Since the drain thread writes the events of a ring in order, it can compute those
+ * differences as it goes.
  *
  * No "normal" Probe object has an ID of zero. Such objects are created when they are the source
  * of a move operation. Thus, the destruction of an object with ID 0 means a moved-from object
@@ -18,51 +28,383 @@
  * source object. Its orginal ID number is lost (and won't appear during destruction).
  */
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 #include "Probe.hpp"
+#include "ProbeTrace.hpp"
+
+namespace {
+
+    typedef probe_trace::RecordKind EventKind;
+
+    struct Event {
+        std::uint64_t time;    // Nanoseconds since recording started.
+        int           ID;      // The object the event happened to.
+        int           source;  // The object copied or moved from, if any.
+        unsigned      type;
+        EventKind     kind;
+    };
+
+    // IDs are handed out by all threads, so the counter must be atomic. Only uniqueness
+    // matters, not ordering with other memory operations.
+    //
+    std::atomic<int> master_ID( 0 );
+
+    int next_ID( )
+    {
+        return master_ID.fetch_add( 1, std::memory_order_relaxed ) + 1;
+    }
+
+    // The names of the types, indexed by tag. The vector is never destroyed so that probes
+    // destroyed during program exit can still use it.
+    //
+    std::mutex types_lock;
+
+    std::vector<std::string> &type_names( )
+    {
+        static std::vector<std::string> *names = new std::vector<std::string>( 1, "Probe" );
+        return *names;
+    }
+
+    std::string type_name( unsigned type )
+    {
+        std::lock_guard<std::mutex> lock( types_lock );
+        return type_names( )[type];
+    }
+
+    void write_event( std::ostream &output, const Event &event )
+    {
+        if( event.type != 0 ) output << type_name( event.type ) << ": ";
+        switch( event.kind ) {
+        case EventKind::default_construct:
+            output << "Default constructor: (new) ID = " << event.ID;
+            break;
+        case EventKind::copy_construct:
+            output << "Copy constructor: (new) ID = " << event.ID
+                   << ". Copying from " << event.source;
+            break;
+        case EventKind::copy_assign:
+            output << "Copy assignment: ID = " << event.ID
+                   << ". Copying from " << event.source;
+            break;
+        case EventKind::destroy:
+            output << "Destructor: " << event.ID;
+            break;
+        case EventKind::move_construct:
+            output << "Move constructor: ID = (assuming source ID). Moving from " << event.source;
+            break;
+        case EventKind::move_assign:
+            output << "Move assignment: ID = " << event.ID
+                   << ". Moving from " << event.source << " (assuming source ID)";
+            break;
+        case EventKind::type_name:
+            break;
+        }
+    }
+
+    void write_binary_event( std::ostream &output, int thread, std::uint64_t delta, const Event &event )
+    {
+        using probe_trace::put_varint;
+
+        char buffer[1 + 5 * 10];
+        char *p = buffer;
+        *p++ = static_cast<char>( event.kind );
+        p = put_varint( p, static_cast<std::uint64_t>( thread ) );
+        p = put_varint( p, delta );
+        p = put_varint( p, event.type );
+        p = put_varint( p, static_cast<std::uint64_t>( event.ID ) );
+        if( probe_trace::has_source( event.kind ) ) {
+            p = put_varint( p, static_cast<std::uint64_t>( event.source ) );
+        }
+        output.write( buffer, p - buffer );
+    }
+
+    void write_binary_type( std::ostream &output, unsigned type, const std::string &name )
+    {
+        char buffer[1 + 2 * 10];
+        char *p = buffer;
+        *p++ = static_cast<char>( probe_trace::RecordKind::type_name );
+        p = probe_trace::put_varint( p, type );
+        p = probe_trace::put_varint( p, name.size( ) );
+        output.write( buffer, p - buffer );
+        output.write( name.data( ), static_cast<std::streamsize>( name.size( ) ) );
+    }
+
+
+    // A single producer, single consumer queue of events. The indices only increase; their
+    // difference is the number of events in the ring.
+    //
+    class Ring {
+    public:
+        static const std::size_t capacity = 4096;  // Must be a power of two.
+
+        explicit Ring( int thread ) : thread( thread ) { }
+
+        // Called only by the thread that owns the ring. Returns false if the ring is full.
+        bool push( const Event &event )
+        {
+            const std::size_t h = head.load( std::memory_order_relaxed );
+            if( h - tail.load( std::memory_order_acquire ) == capacity ) return false;
+            events[h & ( capacity - 1 )] = event;
+            head.store( h + 1, std::memory_order_release );
+            return true;
+        }
+
+        // Called only by the drain thread. Writes every event in the ring to output and returns
+        // the number written.
+        //
+        std::size_t drain( std::ostream &output, Probe::Format format )
+        {
+            const std::size_t t = tail.load( std::memory_order_relaxed );
+            const std::size_t h = head.load( std::memory_order_acquire );
+            for( std::size_t i = t; i != h; ++i ) {
+                const Event &event = events[i & ( capacity - 1 )];
+                if( format == Probe::Format::binary ) {
+                    write_binary_event( output, thread, event.time - last_time, event );
+                    last_time = event.time;
+                }
+                else {
+                    output << event.time << " [" << thread << "] ";
+                    write_event( output, event );
+                    output << '\n';
+                }
+            }
+            tail.store( h, std::memory_order_release );
+            return h - t;
+        }
+
+        const int thread;                     // Numbers the threads in the output.
+        std::atomic<bool> finished{ false };  // Set when the owning thread exits.
+        std::uint64_t last_time = 0;          // The time of the last event drained.
+
+    private:
+        Event events[capacity];
+        alignas( 64 ) std::atomic<std::size_t> head{ 0 };  // Written by the producer.
+        alignas( 64 ) std::atomic<std::size_t> tail{ 0 };  // Written by the consumer.
+    };
+
+
+    // The state of one recording. The drain thread holds a reference to each ring, so a ring
+    // outlives its thread until its last events have been written.
+    //
+    class Recorder {
+    public:
+        Recorder( std::ostream &output, Probe::Format format, unsigned generation ) :
+            generation( generation ),
+            output( output ),
+            format( format ),
+            start( std::chrono::steady_clock::now( ) )
+        {
+            if( format == Probe::Format::binary ) {
+                output.write( probe_trace::trace_magic, sizeof( probe_trace::trace_magic ) );
+            }
+            drainer = std::thread( &Recorder::drain_loop, this );
+        }
+
+        ~Recorder( )
+        {
+            running.store( false, std::memory_order_release );
+            drainer.join( );
+            output.flush( );
+        }
+
+        std::uint64_t now( ) const
+        {
+            return static_cast<std::uint64_t>( std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now( ) - start ).count( ) );
+        }
+
+        std::shared_ptr<Ring> add_ring( )
+        {
+            std::lock_guard<std::mutex> lock( rings_lock );
+            rings.push_back( std::make_shared<Ring>( static_cast<int>( ++thread_count ) ) );
+            return rings.back( );
+        }
+
+        const unsigned generation;  // Distinguishes this recording from earlier ones.
+
+    private:
+        std::ostream                      &output;
+        const Probe::Format                format;
+        const std::chrono::steady_clock::time_point start;
+        std::mutex                         rings_lock;
+        std::vector<std::shared_ptr<Ring>> rings;
+        unsigned                           thread_count = 0;
+        std::size_t                        types_written = 1;  // Type 0 needs no record.
+        std::atomic<bool>                  running{ true };
+        std::thread                        drainer;
+
+        void drain_loop( );
+        void write_types( );
+    };
+
+
+    //
+    // Recorder::write_types
+    //
+    // Adds a type record to a binary trace for every type defined since the last call.
+    //
+    void Recorder::write_types( )
+    {
+        std::lock_guard<std::mutex> lock( types_lock );
+        const std::vector<std::string> &names = type_names( );
+        for( ; types_written < names.size( ); ++types_written ) {
+            write_binary_type( output, static_cast<unsigned>( types_written ), names[types_written] );
+        }
+    }
+
+
+    //
+    // Recorder::drain_loop
+    //
+    // The list of rings is copied so that threads registering new rings don't wait for the
+    // output. One last pass is made after recording stops to pick up the final events.
+    //
+    void Recorder::drain_loop( )
+    {
+        bool last_pass = false;
+        while( !last_pass ) {
+            last_pass = !running.load( std::memory_order_acquire );
+
+            std::vector<std::shared_ptr<Ring>> current;
+            {
+                std::lock_guard<std::mutex> lock( rings_lock );
+                current = rings;
+            }
+
+            std::size_t count = 0;
+            for( const std::shared_ptr<Ring> &ring : current ) {
+                // Read finished first: if it was set, the thread's last event is already in
+                // the ring, so draining after that leaves the ring empty for good.
+                const bool finished = ring->finished.load( std::memory_order_acquire );
+                count += ring->drain( output, format );
+                if( finished ) {
+                    std::lock_guard<std::mutex> lock( rings_lock );
+                    for( std::size_t i = 0; i < rings.size( ); ++i ) {
+                        if( rings[i] == ring ) {
+                            rings.erase( rings.begin( ) + static_cast<std::ptrdiff_t>( i ) );
+                            break;
+                        }
+                    }
+                }
+            }
+            if( format == Probe::Format::binary ) write_types( );
+            if( count == 0 && !last_pass ) {
+                std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+            }
+        }
+    }
+
+
+    // The active recording, or null when events go to std::cout. This is a plain pointer with
+    // no destructor so that Probe objects destroyed during program exit can still use it.
+    //
+    std::atomic<Recorder *> active{ nullptr };
+    unsigned recording_count = 0;
+
+    // Each thread's ring for the current recording. When the thread exits, the ring is marked
+    // finished so the drain thread can let go of it.
+    //
+    struct ThreadRing {
+        std::shared_ptr<Ring> ring;
+        unsigned generation = 0;
+
+        ~ThreadRing( ) { if( ring ) ring->finished.store( true, std::memory_order_release ); }
+    };
+
+    void record( EventKind kind, unsigned type, int ID, int source )
+    {
+        Recorder *recorder = active.load( std::memory_order_acquire );
+        if( recorder == nullptr ) {
+            Event event = { 0, ID, source, type, kind };
+            write_event( std::cout, event );
+            std::cout << '\n';
+            return;
+        }
+
+        thread_local ThreadRing local;
+        if( local.generation != recorder->generation ) {
+            if( local.ring ) local.ring->finished.store( true, std::memory_order_release );
+            local.ring = recorder->add_ring( );
+            local.generation = recorder->generation;
+        }
+
+        const Event event = { recorder->now( ), ID, source, type, kind };
+        while( !local.ring->push( event ) ) {
+            std::this_thread::yield( );
+        }
+    }
+
+}
+
+
+unsigned Probe::define_type( const char *name )
+{
+    // A name is often registered where a probe is constructed, so the same name comes back
+    // many times. There are only a few types, so a linear search is fine.
+    std::lock_guard<std::mutex> lock( types_lock );
+    std::vector<std::string> &names = type_names( );
+    for( std::size_t i = 0; i < names.size( ); ++i ) {
+        if( names[i] == name ) return static_cast<unsigned>( i );
+    }
+    names.push_back( name );
+    return static_cast<unsigned>( names.size( ) - 1 );
+}
+
+
+void Probe::start_recording( std::ostream &output, Format format )
+{
+    stop_recording( );
+    active.store( new Recorder( output, format, ++recording_count ), std::memory_order_release );
+}
+
+
+void Probe::stop_recording( )
+{
+    delete active.exchange( nullptr, std::memory_order_acq_rel );
+}
+
 
-static int master_ID = 0;
+Probe::Probe( ) : Probe( 0 )
+{ }
 
-Probe::Probe( )
+Probe::Probe( unsigned type ) : type( type )
 {
-    ID_number   = ++master_ID;
-    std::cout << "Default constructor: (new) ID = "
-              << ID_number << std::endl;
+    ID_number = next_ID( );
+    record( EventKind::default_construct, type, ID_number, 0 );
 }
 
-Probe::Probe( const Probe &existing )
+Probe::Probe( const Probe &existing ) : type( existing.type )
 {
-    ID_number = ++master_ID;
-    std::cout << "Copy constructor: (new) ID = "
-              << ID_number
-              << ". Copying from "
-              << existing.ID_number << std::endl;
+    ID_number = next_ID( );
+    record( EventKind::copy_construct, type, ID_number, existing.ID_number );
 }
 
 Probe &Probe::operator=( const Probe &other )
 {
     // Ignore self-assignment.
     if( this != &other ) {
-        std::cout << "Copy assignment: ID = "
-                  << ID_number
-                  << ". Copying from "
-                  << other.ID_number << std::endl;
+        record( EventKind::copy_assign, type, ID_number, other.ID_number );
     }
     return *this;
 }
 
 Probe::~Probe( )
 {
-    std::cout << "Destructor: " << ID_number << std::endl;
+    record( EventKind::destroy, type, ID_number, 0 );
 }
 
 
-Probe::Probe( Probe &&existing )
+Probe::Probe( Probe &&existing ) : type( existing.type )
 {
-    std::cout << "Move constructor: ID = "
-              << "(assuming source ID)"
-              << ". Moving from "
-              << existing.ID_number << std::endl;
+    record( EventKind::move_construct, type, existing.ID_number, existing.ID_number );
     ID_number = existing.ID_number;
     existing.ID_number = 0;
 }
@@ -72,11 +414,7 @@ Probe &Probe::operator=( Probe &&other )
 {
     // Ignore self-assignment.
     if( this != &other ) {
-        std::cout << "Move assignment: ID = "
-                  << ID_number
-                  << ". Moving from "
-                  << other.ID_number
-                  << " (assuming source ID)" << std::endl;
+        record( EventKind::move_assign, type, ID_number, other.ID_number );
         ID_number = other.ID_number;
         other.ID_number = 0;
     }
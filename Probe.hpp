@@ -10,8 +10,25 @@
 #ifndef PROBE_HPP
 #define PROBE_HPP
 
+#include <iosfwd>
+
 class Probe {
 public:
+    // The ways events can be written while recording. The binary format is described in
+    // ProbeTrace.hpp, and the ProbeAnalyze program summarizes it.
+    //
+    enum class Format { text, binary };
+
+    // Registers a type name and returns the tag for it. Registering a name again returns the
+    // same tag, so it is fine to call this in a member initializer. Probes constructed with the
+    // tag have the name in their events, so that the objects containing them can be told
+    // apart. A copy or move constructed probe has the type of its source. Probes constructed
+    // without a tag have the tag 0, named "Probe".
+    //
+    static unsigned define_type( const char *name );
+
+    explicit Probe( unsigned type );
+
     // C++ 1998...
     Probe( );                           // Default constructor.
     Probe( const Probe & );             // Copy constructor.
@@ -22,8 +39,21 @@ public:
     Probe( Probe && );                  // Move constructor.
     Probe &operator=( Probe && );       // Move assignment operator.
 
+    // Normally each event is written to std::cout as it happens. Between start_recording and
+    // stop_recording, events are instead stored in a buffer belonging to the thread that
+    // caused them, with a time stamp, and a background thread writes them to output in the
+    // given format. A binary trace should go to a stream opened in binary mode. The threads
+    // using Probe objects never wait for each other. They wait for the output only when the
+    // background thread falls behind: a thread whose buffer (4096 events) is full yields until
+    // there is room, so no events are lost. Call stop_recording, which writes any events
+    // still buffered, only when no other thread is using Probe objects.
+    //
+    static void start_recording( std::ostream &output, Format format = Format::text );
+    static void stop_recording( );
+
 private:
-    int ID_number;
+    int      ID_number;
+    unsigned type;
 };
 
 #endif
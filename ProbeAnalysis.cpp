@@ -0,0 +1,133 @@
+/*! \file   ProbeAnalysis.cpp
+ *  \brief  Reading and summarizing binary traces of Probe events.
+ *  \author Peter Chapin <peter.chapin@vermontstate.edu>
+ */
+
+#include <algorithm>
+#include <unordered_map>
+#include "ProbeAnalysis.hpp"
+
+namespace probe_trace {
+
+    namespace {
+
+        // Threads are numbered in the order they first record, so a larger number than this is
+        // taken to be a corrupt trace rather than a reason to allocate a huge table.
+        const std::uint64_t max_thread = 1 << 20;
+
+    }
+
+
+    //
+    // read_trace( std::istream &, Trace & )
+    //
+    // Every number in a trace comes from the file, so none of them are trusted as sizes.
+    //
+    bool read_trace( std::istream &input, Trace &trace )
+    {
+        char magic[sizeof( probe_trace::trace_magic )];
+        if( !input.read( magic, sizeof( magic ) ) ||
+            !std::equal( magic, magic + sizeof( magic ), probe_trace::trace_magic ) ) {
+            return false;
+        }
+
+        std::vector<std::uint64_t> thread_times;
+        int kind_byte;
+        while( ( kind_byte = input.get( ) ) != std::char_traits<char>::eof( ) ) {
+            const RecordKind kind = static_cast<RecordKind>( kind_byte );
+            std::uint64_t values[5] = { };
+
+            if( kind == RecordKind::type_name ) {
+                if( !probe_trace::get_varint( input, values[0] ) ) return false;
+                if( !probe_trace::get_varint( input, values[1] ) ) return false;
+
+                // The name is read in pieces so that a bad length runs into the end of the
+                // input instead of allocating that much memory.
+                std::string name;
+                for( std::uint64_t remaining = values[1]; remaining > 0; ) {
+                    char piece[4096];
+                    const std::size_t size =
+                        static_cast<std::size_t>( std::min<std::uint64_t>( remaining, sizeof( piece ) ) );
+                    if( !input.read( piece, static_cast<std::streamsize>( size ) ) ) return false;
+                    name.append( piece, size );
+                    remaining -= size;
+                }
+                trace.type_names[static_cast<unsigned>( values[0] )] = name;
+                continue;
+            }
+            if( kind > RecordKind::type_name ) return false;
+
+            const int fields = probe_trace::has_source( kind ) ? 5 : 4;
+            for( int i = 0; i < fields; ++i ) {
+                if( !probe_trace::get_varint( input, values[i] ) ) return false;
+            }
+
+            // Turn the thread's time differences back into times.
+            if( values[0] > max_thread ) return false;
+            const std::size_t thread = static_cast<std::size_t>( values[0] );
+            if( thread >= thread_times.size( ) ) thread_times.resize( thread + 1, 0 );
+            thread_times[thread] += values[1];
+
+            Event event;
+            event.time   = thread_times[thread];
+            event.type   = static_cast<unsigned>( values[2] );
+            event.ID     = static_cast<int>( values[3] );
+            event.source = static_cast<int>( values[4] );
+            event.kind   = kind;
+            trace.events.push_back( event );
+        }
+        return true;
+    }
+
+
+    std::map<unsigned, TypeStatistics> analyze( std::vector<Event> &events )
+    {
+        std::stable_sort( events.begin( ), events.end( ),
+            []( const Event &left, const Event &right ) { return left.time < right.time; } );
+
+        std::map<unsigned, TypeStatistics> statistics;
+        std::unordered_map<int, std::uint64_t> births;  // The start of each live value, by ID.
+
+        auto end_life = [&]( TypeStatistics &type, int ID, std::uint64_t time ) {
+            auto birth = births.find( ID );
+            if( ID == 0 || birth == births.end( ) ) return;
+            const std::uint64_t lifetime = time - birth->second;
+            ++type.lifetimes;
+            type.total_lifetime += lifetime;
+            type.longest_lifetime = std::max( type.longest_lifetime, lifetime );
+            births.erase( birth );
+        };
+
+        for( const Event &event : events ) {
+            TypeStatistics &type = statistics[event.type];
+            switch( event.kind ) {
+            case RecordKind::default_construct:
+            case RecordKind::copy_construct:
+                ++( event.kind == RecordKind::default_construct ? type.default_constructs : type.copy_constructs );
+                births[event.ID] = event.time;
+                type.peak_live = std::max( type.peak_live, ++type.live );
+                break;
+            case RecordKind::move_construct:
+                ++type.move_constructs;
+                type.peak_live = std::max( type.peak_live, ++type.live );
+                break;
+            case RecordKind::copy_assign:
+                ++type.copy_assigns;
+                break;
+            case RecordKind::move_assign:
+                ++type.move_assigns;
+                if( event.ID != event.source ) end_life( type, event.ID, event.time );
+                break;
+            case RecordKind::destroy:
+                ++type.destroys;
+                --type.live;
+                end_life( type, event.ID, event.time );
+                break;
+            case RecordKind::type_name:
+                break;
+            }
+        }
+        return statistics;
+    }
+
+}
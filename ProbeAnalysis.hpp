@@ -0,0 +1,58 @@
+/*! \file   ProbeAnalysis.hpp
+ *  \brief  Reading and summarizing binary traces of Probe events.
+ *  \author Peter Chapin <peter.chapin@vermontstate.edu>
+ *
+ * These are the parts of the ProbeAnalyze program that don't depend on how the results are
+ * shown, so that they can be tested on their own.
+ */
+
+#ifndef PROBEANALYSIS_HPP
+#define PROBEANALYSIS_HPP
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <string>
+#include <vector>
+#include "ProbeTrace.hpp"
+
+namespace probe_trace {
+
+    struct Event {
+        std::uint64_t time;
+        unsigned      type;
+        int           ID;
+        int           source;
+        RecordKind    kind;
+    };
+
+    struct TypeStatistics {
+        long          default_constructs = 0;
+        long          copy_constructs    = 0;
+        long          copy_assigns       = 0;
+        long          move_constructs    = 0;
+        long          move_assigns       = 0;
+        long          destroys           = 0;
+        long          live               = 0;
+        long          peak_live          = 0;
+        long          lifetimes          = 0;  // The number of values whose lives ended.
+        std::uint64_t total_lifetime     = 0;
+        std::uint64_t longest_lifetime   = 0;
+    };
+
+    struct Trace {
+        std::vector<Event>                 events;
+        std::map<unsigned, std::string>    type_names;
+    };
+
+    // Reads the records of a trace. Returns false if the trace is malformed.
+    bool read_trace( std::istream &input, Trace &trace );
+
+    // Puts the events in time order and counts them by type. The statistics are described in
+    // ProbeAnalyze.cpp.
+    //
+    std::map<unsigned, TypeStatistics> analyze( std::vector<Event> &events );
+
+}
+
+#endif
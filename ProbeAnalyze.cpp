@@ -0,0 +1,107 @@
+/*! \file   ProbeAnalyze.cpp
+ *  \brief  A program that summarizes a binary trace of Probe events.
+ *  \author Peter Chapin <peter.chapin@vermontstate.edu>
+ *
+ * This program reads a trace written by Probe::start_recording in the binary format and prints
+ * a table with one line for each type of probe. The table shows how many objects of the type
+ * were default constructed, copied, moved, and destroyed, the largest number of them that were
+ * alive at once, and how long their values lived. A type with many more copies than moves is
+ * a place to look for accidental copies.
+ *
+ * The value held by an object lives from the default or copy construction that created it to
+ * the destruction of the object that has its ID in the end. Moves pass a value from object to
+ * object without ending its life. A move assignment ends the life of the value that the
+ * destination held before.
+ *
+ * Events from different threads are put back in time order before they are counted, so the
+ * live object counts are correct for multithreaded programs.
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include "ProbeAnalysis.hpp"
+
+using probe_trace::Trace;
+using probe_trace::TypeStatistics;
+
+namespace {
+
+    void report( const std::map<unsigned, TypeStatistics> &statistics, const Trace &trace )
+    {
+        std::cout << std::left << std::setw( 20 ) << "type" << std::right
+                  << std::setw( 10 ) << "default"
+                  << std::setw( 10 ) << "copy"
+                  << std::setw( 10 ) << "copy="
+                  << std::setw( 10 ) << "move"
+                  << std::setw( 10 ) << "move="
+                  << std::setw( 10 ) << "destroy"
+                  << std::setw( 10 ) << "peak"
+                  << std::setw( 14 ) << "mean life"
+                  << std::setw( 14 ) << "max life" << "\n";
+
+        for( const auto &entry : statistics ) {
+            const TypeStatistics &type = entry.second;
+            const auto name = trace.type_names.find( entry.first );
+            std::string type_name;
+            if( entry.first == 0 ) type_name = "Probe";
+            else if( name != trace.type_names.end( ) ) type_name = name->second;
+            else type_name = "#" + std::to_string( entry.first );
+
+            const double mean_life = ( type.lifetimes == 0 ) ? 0.0 :
+                static_cast<double>( type.total_lifetime ) / type.lifetimes / 1000.0;
+
+            std::cout << std::left << std::setw( 20 ) << type_name << std::right
+                      << std::setw( 10 ) << type.default_constructs
+                      << std::setw( 10 ) << type.copy_constructs
+                      << std::setw( 10 ) << type.copy_assigns
+                      << std::setw( 10 ) << type.move_constructs
+                      << std::setw( 10 ) << type.move_assigns
+                      << std::setw( 10 ) << type.destroys
+                      << std::setw( 10 ) << type.peak_live
+                      << std::fixed << std::setprecision( 3 )
+                      << std::setw( 11 ) << mean_life << " us"
+                      << std::setw( 11 ) << type.longest_lifetime / 1000.0 << " us\n";
+        }
+        std::cout << "\ncopy and move count constructions; copy= and move= count assignments.\n";
+    }
+
+}
+
+int main( int argc, char **argv )
+{
+    if( argc != 2 ) {
+        std::cerr << "Usage: probe_analyze trace-file\n";
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream input( argv[1], std::ios::binary );
+    if( !input ) {
+        std::cerr << "probe_analyze: can't open " << argv[1] << "\n";
+        return EXIT_FAILURE;
+    }
+
+    // A malformed trace can still ask for more memory than there is.
+    try {
+        Trace trace;
+        if( !probe_trace::read_trace( input, trace ) ) {
+            std::cerr << "probe_analyze: " << argv[1] << " is not a valid Probe trace\n";
+            return EXIT_FAILURE;
+        }
+        report( probe_trace::analyze( trace.events ), trace );
+    }
+    catch( const std::bad_alloc & ) {
+        std::cerr << "probe_analyze: " << argv[1] << " is not a valid Probe trace\n";
+        return EXIT_FAILURE;
+    }
+    catch( const std::length_error & ) {
+        std::cerr << "probe_analyze: " << argv[1] << " is not a valid Probe trace\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
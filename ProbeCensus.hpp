@@ -0,0 +1,140 @@
+/*! \file   ProbeCensus.hpp
+ *  \brief  A template that counts the special member calls of a type.
+ *  \author Peter Chapin <peter.chapin@vermontstate.edu>
+ *
+ * Class Probe in Probe.hpp reports every event on every object, which is what a student
+ * wants to see but far too much for a large program. The template here only counts. Each
+ * instantiation vtsu::Probe<Tag> has its own counters for default constructions, copies,
+ * moves, assignments, and destructions, shared by all threads. Putting one in a class, as a
+ * base class or as a member, counts the special member calls of that class, provided the
+ * class's own special members are the compiler generated ones or call those of the probe.
+ * Using the class itself as the tag is the usual choice:
+ *
+ *     class BigInt : private vtsu::Probe<BigInt> { ... };
+ *
+ * As a base class the probe takes no space. Probe<Tag>::snapshot( ) returns the counts so far,
+ * which can be written to a stream to see whether copies dominate moves.
+ *
+ * Defining VTSU_DISABLE_PROBE_CENSUS turns every Probe<Tag> into an empty class with trivial
+ * special members, so it costs nothing at all and doesn't stop the containing class from
+ * being trivially copyable. The snapshots are then all zero. The macro must have the same
+ * setting in every file of a program.
+ */
+
+#ifndef PROBECENSUS_HPP
+#define PROBECENSUS_HPP
+
+#include <atomic>
+#include <ostream>
+
+namespace vtsu {
+
+    // The counts for one type at some moment.
+    struct ProbeCounts {
+        unsigned long long default_constructs = 0;
+        unsigned long long copy_constructs    = 0;
+        unsigned long long move_constructs    = 0;
+        unsigned long long copy_assigns       = 0;
+        unsigned long long move_assigns       = 0;
+        unsigned long long destroys           = 0;
+
+        // The number of objects alive at the time of the snapshot.
+        long long live( ) const
+        {
+            return static_cast<long long>( default_constructs + copy_constructs + move_constructs ) -
+                   static_cast<long long>( destroys );
+        }
+    };
+
+    inline std::ostream &operator<<( std::ostream &output, const ProbeCounts &counts )
+    {
+        return output << "default: " << counts.default_constructs
+                      << ", copy: " << counts.copy_constructs
+                      << ", move: " << counts.move_constructs
+                      << ", copy assign: " << counts.copy_assigns
+                      << ", move assign: " << counts.move_assigns
+                      << ", destroy: " << counts.destroys
+                      << ", live: " << counts.live( );
+    }
+
+#if defined( VTSU_DISABLE_PROBE_CENSUS )
+
+    template<typename Tag>
+    class Probe {
+    public:
+        static constexpr bool enabled = false;
+
+        static ProbeCounts snapshot( ) { return ProbeCounts( ); }
+        static void reset( ) { }
+    };
+
+#else
+
+    template<typename Tag>
+    class Probe {
+    public:
+        static constexpr bool enabled = true;
+
+        Probe( ) noexcept                { count( counters.default_constructs ); }
+        Probe( const Probe & ) noexcept  { count( counters.copy_constructs ); }
+        Probe( Probe && ) noexcept       { count( counters.move_constructs ); }
+       ~Probe( )                         { count( counters.destroys ); }
+
+        Probe &operator=( const Probe & ) noexcept { count( counters.copy_assigns ); return *this; }
+        Probe &operator=( Probe && ) noexcept      { count( counters.move_assigns ); return *this; }
+
+        // Returns the counts so far. Counts made by other threads at the same time may or may
+        // not be included.
+        //
+        static ProbeCounts snapshot( )
+        {
+            ProbeCounts result;
+            result.default_constructs = counters.default_constructs.load( std::memory_order_relaxed );
+            result.copy_constructs    = counters.copy_constructs.load( std::memory_order_relaxed );
+            result.move_constructs    = counters.move_constructs.load( std::memory_order_relaxed );
+            result.copy_assigns       = counters.copy_assigns.load( std::memory_order_relaxed );
+            result.move_assigns       = counters.move_assigns.load( std::memory_order_relaxed );
+            result.destroys           = counters.destroys.load( std::memory_order_relaxed );
+            return result;
+        }
+
+        // Sets all the counts to zero. Objects alive at the time will make live( ) negative
+        // when they are destroyed.
+        //
+        static void reset( )
+        {
+            counters.default_constructs.store( 0, std::memory_order_relaxed );
+            counters.copy_constructs.store( 0, std::memory_order_relaxed );
+            counters.move_constructs.store( 0, std::memory_order_relaxed );
+            counters.copy_assigns.store( 0, std::memory_order_relaxed );
+            counters.move_assigns.store( 0, std::memory_order_relaxed );
+            counters.destroys.store( 0, std::memory_order_relaxed );
+        }
+
+    private:
+        // The counters are only read for reports, so nothing needs to be ordered with them.
+        // They get a cache line of their own so that counting one type doesn't slow down the
+        // data next to it.
+        //
+        struct alignas( 64 ) Counters {
+            std::atomic<unsigned long long> default_constructs{ 0 };
+            std::atomic<unsigned long long> copy_constructs{ 0 };
+            std::atomic<unsigned long long> move_constructs{ 0 };
+            std::atomic<unsigned long long> copy_assigns{ 0 };
+            std::atomic<unsigned long long> move_assigns{ 0 };
+            std::atomic<unsigned long long> destroys{ 0 };
+        };
+
+        static inline Counters counters;
+
+        static void count( std::atomic<unsigned long long> &counter )
+        {
+            counter.fetch_add( 1, std::memory_order_relaxed );
+        }
+    };
+
+#endif
+
+}
+
+#endif
@@ -0,0 +1,159 @@
+/*! \file   ProbeCensusTest.cpp
+ *  \brief  A regression test for the vtsu::Probe<Tag> census template.
+ *  \author Peter Chapin <peter.chapin@vermontstate.edu>
+ *
+ * This file is compiled twice, once as is and once with VTSU_DISABLE_PROBE_CENSUS defined.
+ * With the census enabled, several threads copy and move objects that contain probes and the
+ * counts are checked exactly. With it disabled, the probes must be empty, trivial classes that
+ * change nothing about the classes containing them, and the counts must stay zero.
+ *
+ * The program prints each failure and exits with a failure status if there are any. It is run
+ * by ctest.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "ProbeCensus.hpp"
+
+namespace {
+
+    int failures = 0;
+
+    void check( bool condition, const char *what )
+    {
+        if( !condition ) {
+            ++failures;
+            std::cout << "FAILED: " << what << std::endl;
+        }
+    }
+
+    // A probe as a base class, the usual way.
+    class Point : private vtsu::Probe<Point> {
+    public:
+        int x = 0;
+        int y = 0;
+    };
+
+    // A probe as a member, in a class with members that are expensive to copy.
+    class Record {
+    public:
+        std::string         name = "record";
+        vtsu::Probe<Record> probe;
+    };
+
+    struct PlainPoint {
+        int x = 0;
+        int y = 0;
+    };
+
+    // As a base class the probe takes no space, whether it counts or not.
+    static_assert( std::is_empty<vtsu::Probe<Point>>::value, "Probe<Tag> has data members" );
+    static_assert( sizeof( Point ) == sizeof( PlainPoint ), "Probe<Tag> base takes space" );
+
+#if defined( VTSU_DISABLE_PROBE_CENSUS )
+
+    static_assert( !vtsu::Probe<Point>::enabled, "census not disabled" );
+    static_assert( std::is_trivially_copyable<vtsu::Probe<Point>>::value,
+                   "disabled Probe<Tag> is not trivially copyable" );
+    static_assert( std::is_trivially_default_constructible<vtsu::Probe<Point>>::value,
+                   "disabled Probe<Tag> is not trivially default constructible" );
+    static_assert( std::is_trivially_destructible<vtsu::Probe<Point>>::value,
+                   "disabled Probe<Tag> is not trivially destructible" );
+    static_assert( std::is_trivially_copyable<Point>::value,
+                   "disabled Probe<Tag> makes its class not trivially copyable" );
+
+    void check_census( )
+    {
+        {
+            Point a;
+            Point b( a );
+            b = std::move( a );
+            Record r;
+            Record s( std::move( r ) );
+            s = r;
+        }
+        const vtsu::ProbeCounts counts = vtsu::Probe<Point>::snapshot( );
+        check( counts.default_constructs == 0 && counts.copy_constructs == 0 &&
+               counts.move_assigns == 0 && counts.destroys == 0, "disabled counts are zero" );
+        check( vtsu::Probe<Record>::snapshot( ).live( ) == 0, "disabled live count is zero" );
+        vtsu::Probe<Point>::reset( );
+    }
+
+#else
+
+    static_assert( vtsu::Probe<Point>::enabled, "census disabled" );
+    static_assert( std::is_nothrow_move_constructible<Record>::value,
+                   "Probe<Tag> makes moves throw" );
+
+    const int thread_count = 4;
+    const int rounds       = 10000;
+
+    void exercise( )
+    {
+        for( int i = 0; i < rounds; ++i ) {
+            Point a;
+            Point b( a );
+            b = a;
+            Point c( std::move( a ) );
+            a = std::move( c );
+        }
+    }
+
+    void check_census( )
+    {
+        std::vector<std::thread> threads;
+        for( int i = 0; i < thread_count; ++i ) threads.emplace_back( exercise );
+        for( std::thread &thread : threads ) thread.join( );
+
+        const unsigned long long total = static_cast<unsigned long long>( thread_count ) * rounds;
+        const vtsu::ProbeCounts counts = vtsu::Probe<Point>::snapshot( );
+        check( counts.default_constructs == total, "default constructions" );
+        check( counts.copy_constructs == total, "copy constructions" );
+        check( counts.copy_assigns == total, "copy assignments" );
+        check( counts.move_constructs == total, "move constructions" );
+        check( counts.move_assigns == total, "move assignments" );
+        check( counts.destroys == 3 * total, "destructions" );
+        check( counts.live( ) == 0, "live objects" );
+
+        // Each tag has counters of its own. A vector of records moves them when it grows,
+        // since the probe doesn't make the move constructor throw.
+        {
+            std::vector<Record> records;
+            for( int i = 0; i < 100; ++i ) records.push_back( Record( ) );
+            const vtsu::ProbeCounts during = vtsu::Probe<Record>::snapshot( );
+            check( during.live( ) == 100, "records alive" );
+            check( during.copy_constructs == 0, "records copied while the vector grew" );
+        }
+        check( vtsu::Probe<Record>::snapshot( ).live( ) == 0, "records alive at the end" );
+        check( vtsu::Probe<Point>::snapshot( ).destroys == 3 * total,
+               "tags have counters of their own" );
+
+        std::ostringstream text;
+        text << vtsu::Probe<Point>::snapshot( );
+        check( text.str( ).find( "live: 0" ) != std::string::npos, "writing the counts" );
+
+        vtsu::Probe<Point>::reset( );
+        check( vtsu::Probe<Point>::snapshot( ).default_constructs == 0, "reset" );
+    }
+
+#endif
+
+}
+
+int main( )
+{
+    check_census( );
+
+    if( failures != 0 ) {
+        std::cout << failures << " checks failed\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "All checks passed\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,227 @@
+/*! \file   ProbeRecordingTest.cpp
+ *  \brief  A regression test for the recording mode of class Probe.
+ *  \author Peter Chapin <peter.chapin@vermontstate.edu>
+ *
+ * Several threads do the same fixed series of operations on Probe objects while a recording is
+ * active. The test then reads the recording back and checks that every event of every thread
+ * is there, in order, with time stamps that never go backward. Each thread causes many more
+ * events than its buffer holds, so the threads also have to wait for the drain thread. The
+ * binary recording is read back with the reader used by ProbeAnalyze.
+ *
+ * The program prints each failure and exits with a failure status if there are any. It is run
+ * by ctest.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Probe.hpp"
+#include "ProbeAnalysis.hpp"
+
+namespace {
+
+    const int thread_count = 4;
+    const int rounds       = 2000;   // Eight events each, so 16000 events per thread.
+
+    int failures = 0;
+
+    void check( bool condition, const char *what, long test = 0 )
+    {
+        if( !condition ) {
+            ++failures;
+            std::cout << "FAILED: " << what << " (case " << test << ")" << std::endl;
+        }
+    }
+
+    // A class with a typed probe, registered the usual way in a member initializer.
+    struct Widget {
+        Probe probe{ Probe::define_type( "Widget" ) };
+    };
+
+    // One round causes one event of each kind except destruction, which happens three times.
+    template<typename T>
+    void exercise( )
+    {
+        for( int i = 0; i < rounds; ++i ) {
+            T a;
+            T b( a );
+            b = a;
+            T c( std::move( a ) );
+            a = std::move( c );
+        }
+    }
+
+    // The event counts of one thread in a text recording.
+    struct ThreadEvents {
+        long          defaults = 0;
+        long          copies   = 0;
+        long          copy_assigns = 0;
+        long          moves    = 0;
+        long          move_assigns = 0;
+        long          destroys = 0;
+        unsigned long last_time = 0;
+        bool          in_order  = true;
+    };
+
+    bool starts_with( const std::string &text, const char *prefix )
+    {
+        return text.compare( 0, std::string( prefix ).size( ), prefix ) == 0;
+    }
+
+    // Reads a text recording. Each line is the time stamp, the thread number in brackets, and
+    // the message that Probe writes when it isn't recording.
+    //
+    std::map<int, ThreadEvents> read_text( std::istream &input )
+    {
+        std::map<int, ThreadEvents> threads;
+        std::string line;
+        long line_number = 0;
+        while( std::getline( input, line ) ) {
+            ++line_number;
+            std::istringstream fields( line );
+            unsigned long time;
+            char open, close;
+            int thread;
+            fields >> time >> open >> thread >> close >> std::ws;
+            std::string message;
+            std::getline( fields, message );
+            if( !fields && !fields.eof( ) ) {
+                check( false, "text record layout", line_number );
+                continue;
+            }
+
+            ThreadEvents &events = threads[thread];
+            if( time < events.last_time ) events.in_order = false;
+            events.last_time = time;
+            if( starts_with( message, "Default constructor" ) ) ++events.defaults;
+            else if( starts_with( message, "Copy constructor" ) ) ++events.copies;
+            else if( starts_with( message, "Copy assignment" ) ) ++events.copy_assigns;
+            else if( starts_with( message, "Move constructor" ) ) ++events.moves;
+            else if( starts_with( message, "Move assignment" ) ) ++events.move_assigns;
+            else if( starts_with( message, "Destructor" ) ) ++events.destroys;
+            else check( false, "text record message", line_number );
+        }
+        return threads;
+    }
+
+    void check_thread( const ThreadEvents &events, long expected_rounds, long thread )
+    {
+        check( events.defaults == expected_rounds, "default constructions", thread );
+        check( events.copies == expected_rounds, "copy constructions", thread );
+        check( events.copy_assigns == expected_rounds, "copy assignments", thread );
+        check( events.moves == expected_rounds, "move constructions", thread );
+        check( events.move_assigns == expected_rounds, "move assignments", thread );
+        check( events.destroys == 3 * expected_rounds, "destructions", thread );
+        check( events.in_order, "time stamps in order", thread );
+    }
+
+    // Several threads at once, then a second recording on the main thread alone. The main
+    // thread's buffer from the first recording must not be used by the second.
+    //
+    void check_text( )
+    {
+        std::stringstream first;
+        Probe::start_recording( first );
+        std::vector<std::thread> threads;
+        for( int i = 0; i < thread_count; ++i ) threads.emplace_back( exercise<Probe> );
+        for( std::thread &thread : threads ) thread.join( );
+        exercise<Probe>( );
+
+        std::stringstream second;
+        Probe::start_recording( second );
+        exercise<Probe>( );
+        Probe::stop_recording( );
+
+        const std::map<int, ThreadEvents> recorded = read_text( first );
+        check( recorded.size( ) == thread_count + 1, "threads in the first recording" );
+        std::set<int> numbers;
+        for( const auto &entry : recorded ) {
+            numbers.insert( entry.first );
+            check_thread( entry.second, rounds, entry.first );
+        }
+        check( *numbers.begin( ) == 1 && *numbers.rbegin( ) == thread_count + 1,
+               "threads numbered from 1" );
+
+        const std::map<int, ThreadEvents> again = read_text( second );
+        check( again.size( ) == 1, "threads in the second recording" );
+        if( !again.empty( ) ) check_thread( again.begin( )->second, rounds, 0 );
+    }
+
+    void check_statistics( const probe_trace::TypeStatistics &type, long expected_rounds, long tag )
+    {
+        check( type.default_constructs == expected_rounds, "analyzed default constructions", tag );
+        check( type.copy_constructs == expected_rounds, "analyzed copy constructions", tag );
+        check( type.copy_assigns == expected_rounds, "analyzed copy assignments", tag );
+        check( type.move_constructs == expected_rounds, "analyzed move constructions", tag );
+        check( type.move_assigns == expected_rounds, "analyzed move assignments", tag );
+        check( type.destroys == 3 * expected_rounds, "analyzed destructions", tag );
+        check( type.live == 0, "analyzed live objects at the end", tag );
+        check( type.peak_live >= 3, "analyzed peak live objects", tag );
+
+        // Each round, the values of a and b live until a and b are destroyed. The value of c
+        // moves to a, and c itself is destroyed empty.
+        check( type.lifetimes == 2 * expected_rounds, "analyzed lifetimes", tag );
+    }
+
+    // A binary recording of typed and untyped probes in several threads, read back with the
+    // same code as ProbeAnalyze.
+    //
+    void check_binary( )
+    {
+        std::stringstream recording( std::ios::in | std::ios::out | std::ios::binary );
+        Probe::start_recording( recording, Probe::Format::binary );
+        std::vector<std::thread> threads;
+        for( int i = 0; i < thread_count; ++i ) threads.emplace_back( exercise<Widget> );
+        for( std::thread &thread : threads ) thread.join( );
+        exercise<Probe>( );
+        Probe::stop_recording( );
+
+        probe_trace::Trace trace;
+        check( probe_trace::read_trace( recording, trace ), "read_trace" );
+        check( trace.events.size( ) == 8UL * rounds * ( thread_count + 1 ), "events in the trace" );
+
+        const unsigned widget = Probe::define_type( "Widget" );
+        check( widget != 0, "Widget has a tag of its own" );
+        check( trace.type_names.size( ) == 1 && trace.type_names[widget] == "Widget",
+               "one type record for Widget" );
+
+        std::map<unsigned, probe_trace::TypeStatistics> statistics =
+            probe_trace::analyze( trace.events );
+        check( statistics.size( ) == 2, "types in the trace" );
+        check_statistics( statistics[0], rounds, 0 );
+        check_statistics( statistics[widget], long( rounds ) * thread_count, widget );
+        check( statistics[widget].peak_live <= 3 * thread_count, "Widget peak live objects" );
+
+        // Malformed traces are rejected rather than trusted: a type name of 2^63 - 1
+        // characters, an event from thread 2^62, and a trace too short for the magic number.
+        //
+        const std::string bad_length( "PRB1\x06\x01\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\x7F", 15 );
+        const std::string bad_thread(
+            "PRB1\x00\x80\x80\x80\x80\x80\x80\x80\x80\x40\x01\x01\x01", 17 );
+        for( const std::string &bad : { bad_length, bad_thread, std::string( "PRB" ) } ) {
+            std::istringstream input( bad );
+            probe_trace::Trace ignored;
+            check( !probe_trace::read_trace( input, ignored ), "malformed trace rejected" );
+        }
+    }
+
+}
+
+int main( )
+{
+    check_text( );
+    check_binary( );
+
+    if( failures != 0 ) {
+        std::cout << failures << " checks failed\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "All checks passed\n";
+    return EXIT_SUCCESS;
+}
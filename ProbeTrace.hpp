@@ -0,0 +1,77 @@
+/*! \file   ProbeTrace.hpp
+ *  \brief  The binary format of Probe event traces.
+ *  \author Peter Chapin <peter.chapin@vermontstate.edu>
+ *
+ * A binary trace starts with the four bytes of trace_magic, followed by records. Every record
+ * starts with a byte giving its kind. All numbers are unsigned varints: seven bits per byte,
+ * least significant group first, with the high bit set on every byte but the last. Event
+ * records contain
+ *
+ *   thread   The recording thread, numbered from 1.
+ *   delta    Nanoseconds since the previous event of the same thread (since the start of the
+ *            recording for its first event).
+ *   type     The type tag of the probe (see Probe::define_type).
+ *   ID       The ID of the probe the event happened to. For a move construction, this is the
+ *            ID it took over.
+ *   source   The ID copied or moved from. Only copy and move records have this field.
+ *
+ * A type record contains a type tag, the length of its name, and the characters of the name.
+ * Type records can appear anywhere in the trace, not necessarily before the events that use
+ * their tags. Type 0 is always the untyped Probe and has no type record. Most events take
+ * six to ten bytes.
+ */
+
+#ifndef PROBETRACE_HPP
+#define PROBETRACE_HPP
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+namespace probe_trace {
+
+    const char trace_magic[4] = { 'P', 'R', 'B', '1' };
+
+    enum class RecordKind : unsigned char {
+        default_construct, copy_construct, copy_assign, destroy, move_construct, move_assign,
+        type_name
+    };
+
+    // True for the event records that have a source field.
+    inline bool has_source( RecordKind kind )
+    {
+        return kind == RecordKind::copy_construct || kind == RecordKind::copy_assign ||
+               kind == RecordKind::move_construct || kind == RecordKind::move_assign;
+    }
+
+    // Writes value as a varint to the buffer at p. Returns a pointer past the last byte. At most
+    // ten bytes are written.
+    //
+    inline char *put_varint( char *p, std::uint64_t value )
+    {
+        while( value >= 0x80 ) {
+            *p++ = static_cast<char>( ( value & 0x7F ) | 0x80 );
+            value >>= 7;
+        }
+        *p++ = static_cast<char>( value );
+        return p;
+    }
+
+    // Reads a varint from input. Returns false at the end of the input or if the varint is
+    // malformed.
+    //
+    inline bool get_varint( std::istream &input, std::uint64_t &value )
+    {
+        value = 0;
+        for( int shift = 0; shift < 64; shift += 7 ) {
+            const int ch = input.get( );
+            if( ch == std::char_traits<char>::eof( ) ) return false;
+            value |= static_cast<std::uint64_t>( ch & 0x7F ) << shift;
+            if( ( ch & 0x80 ) == 0 ) return true;
+        }
+        return false;
+    }
+
+}
+
+#endif